@@ -0,0 +1,318 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gk/core/ArgumentParser.hpp"
+#include "gk/core/GameClock.hpp"
+#include "gk/scene/component/CollisionComponent.hpp"
+#include "gk/scene/component/HitboxComponent.hpp"
+#include "gk/scene/component/LifetimeComponent.hpp"
+#include "gk/scene/component/MovementComponent.hpp"
+#include "gk/scene/component/PositionComponent.hpp"
+#include "gk/scene/controller/LifetimeController.hpp"
+#include "gk/scene/controller/MovementController.hpp"
+#include "gk/scene/Scene.hpp"
+#include "gk/scene/SortAndSweepCollisionHelper.hpp"
+#include "gk/scene/SpatialHashCollisionHelper.hpp"
+
+// Headless benchmark of Scene::update, reporting the time per object and per
+// tick of the whole update. With --profile, the times of the movement, the
+// collisions, the lifetimes and the command buffer flushes, which remove the
+// dead objects, are reported too, at the cost of the profiler overhead.
+
+using namespace gk;
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+	std::vector<size_t> objectCounts{1000, 10000, 100000};
+	u32 tickCount = 100;
+
+	std::string helper = "hash";
+	std::string pattern = "random";
+
+	float density = 0.05f;      // Part of the world covered by hitboxes
+	float lifetimeRatio = 0.01f; // Part of the objects dying each tick
+
+	bool hasMovement = true;
+	bool hasCollisions = true;
+	bool hasLifetime = true;
+
+	bool isBatching = false;
+	bool isProfiling = false;
+};
+
+class RandomWalkMovement : public Movement {
+	public:
+		RandomWalkMovement(u32 seed) : m_random(seed) {}
+
+		void process(SceneObject &object) override {
+			auto &movement = object.get<MovementComponent>();
+			if (m_random() % 16 == 0) {
+				std::uniform_real_distribution<float> distribution{-1.f, 1.f};
+				movement.v.x = distribution(m_random);
+				movement.v.y = distribution(m_random);
+			}
+		}
+
+	private:
+		std::minstd_rand m_random;
+};
+
+class BouncingMovement : public Movement {
+	public:
+		BouncingMovement(float worldSize) : m_worldSize(worldSize) {}
+
+		void process(SceneObject &object) override {
+			auto &movement = object.get<MovementComponent>();
+			auto &position = object.get<PositionComponent>();
+			if ((position.x < 0.f && movement.v.x < 0.f) || (position.x > m_worldSize && movement.v.x > 0.f))
+				movement.v.x = -movement.v.x;
+			if ((position.y < 0.f && movement.v.y < 0.f) || (position.y > m_worldSize && movement.v.y > 0.f))
+				movement.v.y = -movement.v.y;
+		}
+
+	private:
+		float m_worldSize;
+};
+
+class Benchmark {
+	public:
+		Benchmark(const Options &options, size_t objectCount)
+			: m_options(options), m_objectCount(objectCount)
+		{
+			// Average hitbox of 12x12
+			m_worldSize = std::sqrt(float(objectCount) * 144.f / options.density);
+		}
+
+		void run() {
+			Scene scene;
+			scene.setProfilingEnabled(m_options.isProfiling);
+
+			if (m_options.helper == "hash")
+				run<SpatialHashCollisionHelper>(scene);
+			else if (m_options.helper == "sweep")
+				run<SortAndSweepCollisionHelper>(scene);
+			else
+				run<CollisionHelper>(scene);
+		}
+
+	private:
+		template<typename Helper>
+		void run(Scene &scene) {
+			scene.setCollisionHelper<Helper>();
+
+			scene.addController<LifetimeController>();
+			scene.addController<MovementController>().setBatchingEnabled(m_options.isBatching);
+
+			for (size_t i = 0 ; i < m_objectCount ; ++i)
+				spawn(scene);
+
+			// One tick to warm up the caches and the broadphase
+			scene.update();
+			refill(scene);
+
+			// The collision phase includes the collision checks of MovementController
+			Clock::duration updateTime{}, movementTime{}, collisionTime{}, lifetimeTime{}, flushTime{};
+			for (m_tick = 0 ; m_tick < m_options.tickCount ; ++m_tick) {
+				auto start = Clock::now();
+				scene.update();
+				updateTime += Clock::now() - start;
+
+				if (scene.profiler()) {
+					for (const SceneProfiler::Stats &stats : scene.profiler()->stats()) {
+						auto lastTime = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float, std::micro>(stats.lastTime));
+						if (stats.name.find("MovementController") != std::string::npos)
+							movementTime += lastTime;
+						else if (stats.name.find("LifetimeController") != std::string::npos)
+							lifetimeTime += lastTime;
+						else if (stats.name.find("CollisionHelper") != std::string::npos)
+							collisionTime += lastTime;
+						else if (stats.name.find("SceneCommandBuffer") != std::string::npos)
+							flushTime += lastTime;
+					}
+				}
+
+				refill(scene);
+			}
+
+			size_t hitsPerTick = m_collisionCount / std::max<size_t>(m_options.tickCount, 1);
+			if (m_options.isProfiling) {
+				std::printf("%10zu %12.1f %12.1f %12.1f %12.1f %12.1f %10zu\n", m_objectCount,
+					nsPerObjectTick(updateTime),
+					nsPerObjectTick(movementTime),
+					nsPerObjectTick(collisionTime),
+					nsPerObjectTick(lifetimeTime),
+					nsPerObjectTick(flushTime),
+					hitsPerTick);
+			}
+			else {
+				std::printf("%10zu %12.1f %12s %12s %12s %12s %10zu\n", m_objectCount,
+					nsPerObjectTick(updateTime), "-", "-", "-", "-", hitsPerTick);
+			}
+		}
+
+		void spawn(Scene &scene) {
+			std::uniform_real_distribution<float> position{0.f, m_worldSize};
+			std::uniform_int_distribution<int> size{8, 16};
+
+			SceneObject object{"object", "bench"};
+			object.set<PositionComponent>(position(m_random), position(m_random));
+
+			if (m_options.hasCollisions) {
+				object.set<HitboxComponent>(0, 0, u16(size(m_random)), u16(size(m_random)));
+				object.set<CollisionComponent>().addAction([this] (SceneObject &, SceneObject &, bool inCollision) {
+					m_collisionCount += inCollision;
+				});
+			}
+
+			if (m_options.hasMovement && m_options.pattern != "static") {
+				// Linear movements have no Movement, so they're batched if they don't collide
+				Movement *movement = nullptr;
+				if (m_options.pattern == "bounce")
+					movement = new BouncingMovement(m_worldSize);
+				else if (m_options.pattern != "linear")
+					movement = new RandomWalkMovement(u32(m_random()));
+
+				auto &movementComponent = object.set<MovementComponent>(movement);
+				std::uniform_real_distribution<float> velocity{-1.f, 1.f};
+				movementComponent.v = {velocity(m_random), velocity(m_random)};
+			}
+			else if (m_options.hasCollisions) {
+				object.get<HitboxComponent>().setStatic(true);
+			}
+
+			if (m_options.hasLifetime) {
+				// Game time doesn't advance without a window, so deaths are driven by ticks
+				std::geometric_distribution<u32> lifetime{std::max(m_options.lifetimeRatio, 1e-6f)};
+				u32 deathTick = m_tick + 1 + lifetime(m_random);
+
+				auto &lifetimeComponent = object.set<LifetimeComponent>([this, deathTick] (const SceneObject &) {
+					return m_tick >= deathTick;
+				});
+				lifetimeComponent.setClientsNotified(true);
+			}
+
+			scene.addObject(std::move(object));
+		}
+
+		// Keeps the number of objects constant
+		void refill(Scene &scene) {
+			while (scene.objects().size() < m_objectCount)
+				spawn(scene);
+		}
+
+		double nsPerObjectTick(Clock::duration duration) const {
+			return double(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()) / double(m_objectCount) / double(std::max<u32>(m_options.tickCount, 1));
+		}
+
+		const Options &m_options;
+		size_t m_objectCount;
+
+		float m_worldSize;
+
+		u32 m_tick = 0;
+		size_t m_collisionCount = 0;
+
+		std::minstd_rand m_random{42};
+};
+
+int main(int argc, char **argv) {
+	ArgumentParser parser{argc, argv};
+	parser.addArgument("objects", {"-n", "--objects", "Comma-separated object counts (default: 1000,10000,100000).", "counts"});
+	parser.addArgument("ticks", {"-t", "--ticks", "Number of ticks per run (default: 100).", "count"});
+	parser.addArgument("helper", {"-c", "--collision-helper", "brute, hash or sweep (default: hash).", "helper"});
+	parser.addArgument("pattern", {"-p", "--pattern", "Movement of the objects: random, bounce, linear or static (default: random).", "pattern"});
+	parser.addArgument("density", {"-d", "--density", "Part of the world covered by hitboxes (default: 0.05).", "ratio"});
+	parser.addArgument("lifetime", {"-l", "--lifetime", "Part of the objects dying each tick (default: 0.01).", "ratio"});
+	parser.addArgument("components", {"-m", "--components", "Comma-separated components: movement, collision, lifetime (default: all).", "list"});
+	parser.addArgument("batch", {"-b", "--batch", "Integrate the linear movements in batches."});
+	parser.addArgument("profile", {"-P", "--profile", "Report the time of each system, which slows the update down."});
+	parser.parse();
+
+	if (parser.getArgument("help").isFound)
+		return 0;
+
+	Options options;
+
+	auto split = [] (const std::string &string) {
+		std::vector<std::string> items;
+		std::stringstream stream{string};
+		for (std::string item ; std::getline(stream, item, ',') ; )
+			items.emplace_back(item);
+		return items;
+	};
+
+	if (parser.getArgument("objects").isFound) {
+		options.objectCounts.clear();
+		for (const std::string &count : split(parser.getArgument("objects").parameter))
+			options.objectCounts.emplace_back(std::stoul(count));
+	}
+
+	if (parser.getArgument("ticks").isFound)
+		options.tickCount = u32(std::stoul(parser.getArgument("ticks").parameter));
+	if (parser.getArgument("helper").isFound)
+		options.helper = parser.getArgument("helper").parameter;
+	if (parser.getArgument("pattern").isFound)
+		options.pattern = parser.getArgument("pattern").parameter;
+	if (parser.getArgument("density").isFound)
+		options.density = std::stof(parser.getArgument("density").parameter);
+	if (parser.getArgument("lifetime").isFound)
+		options.lifetimeRatio = std::stof(parser.getArgument("lifetime").parameter);
+
+	if (parser.getArgument("components").isFound) {
+		std::vector<std::string> components = split(parser.getArgument("components").parameter);
+		auto has = [&] (const char *name) { return std::find(components.begin(), components.end(), name) != components.end(); };
+		options.hasMovement = has("movement");
+		options.hasCollisions = has("collision");
+		options.hasLifetime = has("lifetime");
+	}
+
+	options.isBatching = parser.getArgument("batch").isFound;
+	options.isProfiling = parser.getArgument("profile").isFound;
+
+	GameClock clock;
+	GameClock::setInstance(clock);
+
+	std::printf("helper: %s, pattern: %s, density: %.3f, lifetime: %.3f, ticks: %u\n",
+		options.helper.c_str(), options.pattern.c_str(), double(options.density), double(options.lifetimeRatio), options.tickCount);
+	std::printf("%10s %12s %12s %12s %12s %12s %10s\n", "objects", "update", "movement", "collision", "lifetime", "flush", "hits/tick");
+	std::printf("%10s %12s %12s %12s %12s %12s\n", "", "ns/obj/tick", "ns/obj/tick", "ns/obj/tick", "ns/obj/tick", "ns/obj/tick");
+
+	for (size_t objectCount : options.objectCounts)
+		Benchmark{options, objectCount}.run();
+
+	return 0;
+}
@@ -53,6 +53,16 @@ class GameClock {
 			m_timestep = timestep;
 		}
 
+		// If not 0, a frame is drawn every frameDuration ms even without update,
+		// which is only useful if the drawing interpolates between the updates
+		void setFrameDuration(u8 frameDuration) {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_frameDuration = frameDuration;
+		}
+
+		// Time elapsed since the last update, as a fraction of the timestep
+		float getInterpolationAlpha();
+
 		static GameClock &getInstance() { return *s_instance; }
 		static void setInstance(GameClock &clock) { s_instance = &clock; }
 
@@ -72,6 +82,7 @@ class GameClock {
 		u32 m_timeDropped = 0;
 
 		u8 m_timestep = 6;
+		u8 m_frameDuration = 0;
 		u8 m_numUpdates = 0;
 
 		u32 m_fpsTimer = 0;
@@ -0,0 +1,113 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#ifndef GK_THREADPOOL_HPP_
+#define GK_THREADPOOL_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "gk/core/IntTypes.hpp"
+
+namespace gk {
+
+////////////////////////////////////////////////////////////
+/// \brief Fixed set of worker threads running batches of tasks
+///
+////////////////////////////////////////////////////////////
+class ThreadPool {
+	public:
+		////////////////////////////////////////////////////////////
+		/// \brief Constructor
+		///
+		/// \param workerCount Number of threads created, in addition to the one calling run()
+		///
+		////////////////////////////////////////////////////////////
+		explicit ThreadPool(u16 workerCount);
+
+		ThreadPool(const ThreadPool &) = delete;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Destructor
+		///
+		/// Waits for the workers to finish
+		///
+		////////////////////////////////////////////////////////////
+		~ThreadPool();
+
+		ThreadPool &operator=(const ThreadPool &) = delete;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Run task(0) to task(taskCount - 1) on the workers and the calling thread
+		///
+		/// Returns once all the tasks are done. If a task throws, the
+		/// remaining ones are still run and the first exception is rethrown.
+		///
+		/// Must not be called from a task.
+		///
+		/// \param taskCount Number of tasks
+		/// \param task Function called with the index of each task
+		///
+		////////////////////////////////////////////////////////////
+		void run(size_t taskCount, const std::function<void(size_t)> &task);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Get the number of worker threads
+		///
+		/// \return The number of threads, without the one calling run()
+		///
+		////////////////////////////////////////////////////////////
+		u16 workerCount() const { return static_cast<u16>(m_workers.size()); }
+
+	private:
+		void workerLoop();
+		void runTasks();
+
+		std::vector<std::thread> m_workers;
+
+		std::mutex m_mutex;
+		std::condition_variable m_startCondition;
+		std::condition_variable m_doneCondition;
+
+		const std::function<void(size_t)> *m_task = nullptr;
+		size_t m_taskCount = 0;
+		std::atomic<size_t> m_nextTask{0};
+
+		u64 m_batch = 0;
+		u16 m_activeWorkers = 0;
+		bool m_isStopping = false;
+
+		std::exception_ptr m_exception;
+};
+
+} // namespace gk
+
+#endif // GK_THREADPOOL_HPP_
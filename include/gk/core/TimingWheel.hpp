@@ -0,0 +1,187 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#ifndef GK_TIMINGWHEEL_HPP_
+#define GK_TIMINGWHEEL_HPP_
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "gk/core/IntTypes.hpp"
+
+namespace gk {
+
+////////////////////////////////////////////////////////////
+/// \brief Hierarchical timing wheel, calling a function when the date of each value is reached
+///
+/// Values are stored in the slot of their date on the first level covering
+/// it, and moved down to the lower levels as time goes on, so advancing the
+/// wheel only touches the values that expire or change level.
+///
+////////////////////////////////////////////////////////////
+template<typename T>
+class TimingWheel {
+	public:
+		////////////////////////////////////////////////////////////
+		/// \brief Add a value to the wheel
+		///
+		/// \param date Date at which the value expires, dates already reached expire on next advance()
+		/// \param value Value passed to the function given to advance()
+		///
+		////////////////////////////////////////////////////////////
+		void schedule(u32 date, const T &value) {
+			++m_size;
+
+			if (static_cast<s32>(date - m_time) < 0)
+				m_late.push_back({date, value});
+			else
+				insert({date, value});
+		}
+
+		////////////////////////////////////////////////////////////
+		/// \brief Call func(value) for each value whose date is lower or equal to time
+		///
+		/// Values are given by date, then by order of insertion.
+		///
+		/// \param time Current date, never lower than the one of the previous call
+		/// \param func Function called with each expired value
+		///
+		////////////////////////////////////////////////////////////
+		template<typename Func>
+		void advance(u32 time, Func &&func) {
+			if (!m_late.empty()) {
+				std::stable_sort(m_late.begin(), m_late.end(), [] (const Entry &entry1, const Entry &entry2) {
+					return static_cast<s32>(entry1.date - entry2.date) < 0;
+				});
+
+				m_expired.swap(m_late);
+				fire(func);
+			}
+
+			while (m_size != 0 && static_cast<s32>(time - m_time) >= 0) {
+				// Values of the higher levels are moved down when their slot is reached
+				for (u32 level = 1 ; level < levelCount && (m_time & ((1u << (level * slotBits)) - 1)) == 0 ; ++level) {
+					reinsert(m_slots[level][(m_time >> (level * slotBits)) & slotMask]);
+
+					if (level == levelCount - 1)
+						reinsert(m_overflow);
+				}
+
+				std::vector<Entry> &slot = m_slots[0][m_time & slotMask];
+				if (!slot.empty()) {
+					m_expired.swap(slot);
+					fire(func);
+				}
+
+				++m_time;
+			}
+
+			// Nothing to wait for, the wheel can jump to the next date directly
+			if (m_size == 0 && static_cast<s32>(time - m_time) >= 0)
+				m_time = time + 1;
+		}
+
+		////////////////////////////////////////////////////////////
+		/// \brief Remove all the values
+		///
+		////////////////////////////////////////////////////////////
+		void clear() {
+			for (auto &level : m_slots)
+				for (auto &slot : level)
+					slot.clear();
+
+			m_overflow.clear();
+			m_late.clear();
+			m_size = 0;
+		}
+
+		////////////////////////////////////////////////////////////
+		/// \brief Get the number of values waiting in the wheel
+		///
+		////////////////////////////////////////////////////////////
+		size_t size() const { return m_size; }
+
+	private:
+		static constexpr u32 slotBits = 6;
+		static constexpr u32 slotCount = 1u << slotBits;
+		static constexpr u32 slotMask = slotCount - 1;
+		static constexpr u32 levelCount = 4;
+
+		struct Entry {
+			u32 date;
+			T value;
+		};
+
+		template<typename Func>
+		void fire(Func &func) {
+			m_size -= m_expired.size();
+
+			for (Entry &entry : m_expired)
+				func(entry.value);
+
+			m_expired.clear();
+		}
+
+		void insert(Entry &&entry) {
+			u32 delay = entry.date - m_time;
+			u32 date = entry.date;
+
+			for (u32 level = 0 ; level < levelCount ; ++level) {
+				if (delay < (1u << ((level + 1) * slotBits))) {
+					m_slots[level][(date >> (level * slotBits)) & slotMask].emplace_back(std::move(entry));
+					return;
+				}
+			}
+
+			m_overflow.emplace_back(std::move(entry));
+		}
+
+		void reinsert(std::vector<Entry> &slot) {
+			if (slot.empty())
+				return;
+
+			m_moved.swap(slot);
+			for (Entry &entry : m_moved)
+				insert(std::move(entry));
+
+			m_moved.clear();
+		}
+
+		std::vector<Entry> m_slots[levelCount][slotCount];
+		std::vector<Entry> m_overflow; // Values expiring after the range of the highest level
+		std::vector<Entry> m_late;     // Values scheduled with a date already reached
+
+		std::vector<Entry> m_expired;
+		std::vector<Entry> m_moved;
+
+		u32 m_time = 0;                // Next date to process
+		size_t m_size = 0;
+};
+
+} // namespace gk
+
+#endif // GK_TIMINGWHEEL_HPP_
@@ -59,6 +59,10 @@ class RenderTarget {
 		void setView(const View &view) { m_view = const_cast<View*>(&view); m_viewChanged = true; }
 		void disableView() { m_view = nullptr; }
 
+		// Rectangle visible through the current view, in the coordinates transformed by
+		// the given transform. Unknown without view and for perspective cameras.
+		bool getVisibleRect(const Transform &transform, FloatRect &rect) const;
+
 	private:
 		IntRect getViewport(const View &view) const;
 
@@ -55,6 +55,7 @@ class Shader {
 		void defaultAttributeLocationBinding();
 
 		void addShader(GLenum type, const std::string &filename);
+		void addShaderFromSource(GLenum type, const std::string &sourceCode, const std::string &name = "<source>");
 
 		GLint attrib(const std::string &name) const;
 		GLint uniform(const std::string &name) const;
@@ -40,6 +40,7 @@
 #include "gk/graphics/Image.hpp"
 #include "gk/graphics/RectangleShape.hpp"
 #include "gk/graphics/Sprite.hpp"
+#include "gk/graphics/SpriteBatch.hpp"
 #include "gk/graphics/Text.hpp"
 #include "gk/graphics/Tilemap.hpp"
 
@@ -32,6 +32,7 @@
 #include "gk/gl/Drawable.hpp"
 #include "gk/gl/Texture.hpp"
 #include "gk/gl/Transformable.hpp"
+#include "gk/gl/Vertex.hpp"
 #include "gk/gl/VertexBuffer.hpp"
 
 namespace gk {
@@ -65,6 +66,9 @@ class Image : public Drawable, public Transformable {
 	protected:
 		void updateVertexBuffer() const;
 
+		// Quad in local coordinates, in the order expected by the indices used in draw()
+		void getVertices(Vertex vertices[4]) const;
+
 		void draw(RenderTarget &target, RenderStates states) const override;
 
 		const Texture *m_texture = nullptr;
@@ -72,6 +76,8 @@ class Image : public Drawable, public Transformable {
 		VertexBuffer m_vbo;
 
 	private:
+		friend class SpriteBatch;
+
 		u16 m_width = 0;
 		u16 m_height = 0;
 
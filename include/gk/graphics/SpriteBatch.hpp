@@ -0,0 +1,121 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#ifndef GK_SPRITEBATCH_HPP_
+#define GK_SPRITEBATCH_HPP_
+
+#include <memory>
+#include <vector>
+
+#include "gk/core/IntTypes.hpp"
+#include "gk/gl/Drawable.hpp"
+#include "gk/gl/Transform.hpp"
+#include "gk/gl/Vertex.hpp"
+#include "gk/gl/VertexBuffer.hpp"
+
+namespace gk {
+
+class Image;
+class Shader;
+class Texture;
+
+////////////////////////////////////////////////////////////
+/// \brief Draws many images with one draw call per texture and shader
+///
+/// The quads are transformed on the CPU when they're added, then all of
+/// them are uploaded in a single buffer when the batch is drawn.
+///
+////////////////////////////////////////////////////////////
+class SpriteBatch : public Drawable {
+	public:
+		SpriteBatch() = default;
+
+		////////////////////////////////////////////////////////////
+		/// \brief Add the quad of an image
+		///
+		/// \param image     Image or Sprite to add
+		/// \param transform Transform applied after the one of the image
+		/// \param shader    Shader to use, or nullptr for the one of the render states
+		///
+		////////////////////////////////////////////////////////////
+		void add(const Image &image, const Transform &transform = Transform::Identity, const Shader *shader = nullptr);
+
+		////////////////////////////////////////////////////////////
+		/// \brief Add a quad whose vertices are already transformed
+		///
+		/// \param texture  Texture of the quad
+		/// \param vertices The 4 vertices of the quad, in the order of Image::getVertices()
+		/// \param shader   Shader to use, or nullptr for the one of the render states
+		///
+		////////////////////////////////////////////////////////////
+		void add(const Texture *texture, const Vertex *vertices, const Shader *shader = nullptr);
+
+		void clear();
+
+		////////////////////////////////////////////////////////////
+		/// \brief Keep the order in which the images were added
+		///
+		/// By default, only consecutive quads using the same texture and
+		/// shader are drawn together. If the order isn't preserved, all
+		/// of them are, which needs less draw calls but may draw images
+		/// using different textures in another order than the one they
+		/// were added in.
+		///
+		////////////////////////////////////////////////////////////
+		void setOrderPreserved(bool isOrderPreserved) { m_isOrderPreserved = isOrderPreserved; }
+		bool isOrderPreserved() const { return m_isOrderPreserved; }
+
+		size_t size() const { return m_quadGroups.size(); }
+		size_t drawCallCount() const { return m_groups.size(); }
+
+	private:
+		void draw(RenderTarget &target, RenderStates states) const override;
+
+		struct Group {
+			const Texture *texture;
+			const Shader *shader;
+
+			u32 quadCount;
+		};
+
+		std::vector<Group> m_groups;
+
+		// Quads in the order they were added, grouped by the indices when drawn
+		std::vector<Vertex> m_vertices;
+		std::vector<u32> m_quadGroups;
+
+		bool m_isOrderPreserved = true;
+
+		// Created by the first draw, so a batch can be filled without a GL context
+		mutable std::unique_ptr<VertexBuffer> m_vbo;
+
+		mutable std::vector<GLuint> m_indices;
+		mutable bool m_isUpdateNeeded = false;
+};
+
+} // namespace gk
+
+#endif // GK_SPRITEBATCH_HPP_
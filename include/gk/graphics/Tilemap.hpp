@@ -30,12 +30,18 @@
 #include "gk/gl/Transformable.hpp"
 #include "gk/graphics/tilemap/TilemapAnimator.hpp"
 #include "gk/graphics/tilemap/TilemapRenderer.hpp"
+#include "gk/graphics/tilemap/TilemapTextureRenderer.hpp"
 #include "gk/graphics/Tileset.hpp"
 
 namespace gk {
 
 class Tilemap : public Drawable, public Transformable {
 	public:
+		enum class RenderMode {
+			Chunks,      // Vertices of the tiles, animated by TilemapAnimator
+			IndexTexture // One quad per layer, tiles and animations read by the shader
+		};
+
 		Tilemap(u16 width, u16 height, Tileset &tileset, const std::vector<std::vector<u16>> &data);
 
 		void reset();
@@ -55,12 +61,18 @@ class Tilemap : public Drawable, public Transformable {
 		u8 layerCount() const { return (u8)m_data.size(); }
 
 		Tileset &tileset() { return m_tileset; }
+		u16 tilesetOffset() const { return m_tilesetOffset; }
 		void setTilesetOffset(u16 tilesetOffset) { m_tilesetOffset = tilesetOffset; }
 
+		RenderMode renderMode() const { return m_renderMode; }
+		void setRenderMode(RenderMode renderMode);
+
 	protected:
 		void draw(RenderTarget &target, RenderStates states) const override;
 
 	private:
+		void updateRendererTile(u8 layer, u16 tileX, u16 tileY, u16 id);
+
 		Tileset &m_tileset;
 		u16 m_tilesetOffset = 0; // FIXME
 
@@ -70,8 +82,11 @@ class Tilemap : public Drawable, public Transformable {
 		std::vector<std::vector<u16>> m_baseData;
 		std::vector<std::vector<u16>> m_data;
 
+		RenderMode m_renderMode = RenderMode::Chunks;
+
 		TilemapAnimator m_animator;
 		TilemapRenderer m_renderer;
+		TilemapTextureRenderer m_textureRenderer;
 };
 
 } // namespace gk
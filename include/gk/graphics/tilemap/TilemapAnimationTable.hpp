@@ -0,0 +1,75 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#ifndef GK_TILEMAPANIMATIONTABLE_HPP_
+#define GK_TILEMAPANIMATIONTABLE_HPP_
+
+#include <vector>
+
+#include "gk/graphics/Tileset.hpp"
+
+namespace gk {
+
+// Pixels of the table used by TilemapTextureRenderer to resolve animations.
+//
+// The first rows give the animation row of each tile ID, or 0 if it isn't
+// animated. Each animation row starts with the frame count and the duration,
+// followed by the tile ID and the end time of each frame.
+class TilemapAnimationTable {
+	public:
+		TilemapAnimationTable(u16 tileCount, u16 offset);
+
+		void addAnimation(u16 tileID, const Tile &tile);
+
+		const std::vector<u8> &pixels() const { return m_pixels; }
+
+		u16 height() const { return m_height; }
+		// Time after which every animation is back to its first frame, except the
+		// ones whose duration didn't fit in a common multiple below maxPeriod
+		u32 period() const;
+
+		// Values are stored as two 16-bit integers, low byte first
+		static void setTexel(u8 *texel, u16 first, u16 second);
+
+		static constexpr u16 width = 256;
+
+		// Longest period whose times in milliseconds are exact as a float, about 4.6 hours
+		static constexpr u32 maxPeriod = 1 << 24;
+
+	private:
+		u16 m_offset = 0;
+		u16 m_height = 0;
+
+		// Time is wrapped to a common multiple of the animation durations, to keep
+		// the precision of the float uniform without breaking the animations
+		u32 m_period = 1;
+
+		std::vector<u8> m_pixels;
+};
+
+} // namespace gk
+
+#endif // GK_TILEMAPANIMATIONTABLE_HPP_
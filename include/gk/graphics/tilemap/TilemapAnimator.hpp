@@ -27,6 +27,9 @@
 #ifndef GK_TILEMAPANIMATOR_HPP_
 #define GK_TILEMAPANIMATOR_HPP_
 
+#include <unordered_map>
+#include <vector>
+
 #include "gk/core/Timer.hpp"
 #include "gk/graphics/Tileset.hpp"
 
@@ -34,19 +37,36 @@ namespace gk {
 
 class Tilemap;
 
+// Only the cells with an animated tile are kept, grouped by tile, and all the
+// cells of a group show the same frame, so the cost of animateTiles() depends
+// on the number of animated tiles in the tileset, not on the size of the map
 class TilemapAnimator {
 	public:
 		void init(Tilemap &map);
 
 		void animateTiles(Tilemap &map);
 
+		// Moves the cell to the group of its new tile
+		void updateTile(Tilemap &map, u16 tileX, u16 tileY, u16 previousID);
+
 	private:
-		struct TileAnimation {
+		void addCell(Tilemap &map, u32 cell, u16 tileID);
+		void removeCell(u32 cell, u16 tileID);
+
+		struct AnimationGroup {
+			u16 tileID;
+
 			Timer timer;
 			u16 currentFrame = 0;
+
+			std::vector<u32> cells;
 		};
 
-		std::vector<TileAnimation> m_tileAnimations;
+		std::vector<AnimationGroup> m_groups;
+		std::unordered_map<u16, u32> m_groupIndices;
+
+		// Position of each cell in the group of its tile
+		std::unordered_map<u32, u32> m_cellPositions;
 };
 
 } // namespace gk
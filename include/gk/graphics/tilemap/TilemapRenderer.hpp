@@ -27,7 +27,11 @@
 #ifndef GK_TILEMAPRENDERER_HPP_
 #define GK_TILEMAPRENDERER_HPP_
 
+#include <memory>
+#include <vector>
+
 #include "gk/gl/Drawable.hpp"
+#include "gk/gl/Vertex.hpp"
 #include "gk/gl/VertexBuffer.hpp"
 #include "gk/graphics/Tileset.hpp"
 
@@ -35,9 +39,17 @@ namespace gk {
 
 class Tilemap;
 
+// The map is split into square chunks of tiles, each one with its own buffer
+// holding only its non-empty tiles. Only the chunks intersecting the view of
+// the render target are drawn.
+//
+// Tile changes are written to a copy of the vertices kept for each chunk, and
+// uploaded when the chunk is drawn, with one call per contiguous range of
+// changed tiles. The whole chunk is uploaded again only if a tile is added or
+// removed.
 class TilemapRenderer : public Drawable {
 	public:
-		TilemapRenderer();
+		static constexpr u16 chunkSize = 32;
 
 		void init(Tilemap *map, u16 mapWidth, u16 mapHeight, u8 mapLayers);
 
@@ -46,9 +58,42 @@ class TilemapRenderer : public Drawable {
 	private:
 		void draw(RenderTarget &target, RenderStates states) const override;
 
-		VertexBuffer m_vbo;
+		static constexpr u16 noSlot = 0xffff;
+
+		struct Chunk {
+			// Created when the chunk has tiles for the first time
+			std::unique_ptr<VertexBuffer> vbo;
+
+			// Copy of the buffer, 6 vertices per non-empty tile
+			std::vector<Vertex> vertices;
+
+			// Position of each tile in the buffer, noSlot if empty
+			std::vector<u16> slots;
+			std::vector<u16> dirtySlots;
+
+			bool isRebuildNeeded = false;
+		};
+
+		Chunk &getChunk(u8 layer, u16 chunkX, u16 chunkY) const;
+
+		void rebuildChunk(Chunk &chunk, u8 layer, u16 chunkX, u16 chunkY) const;
+		void uploadDirtySlots(Chunk &chunk) const;
+
+		void getTileVertices(u16 tileX, u16 tileY, u16 id, Vertex vertices[6]) const;
 
 		Tilemap *m_map = nullptr;
+
+		u16 m_width = 0;
+		u16 m_height = 0;
+		u8 m_layerCount = 0;
+
+		u16 m_chunkCountX = 0;
+		u16 m_chunkCountY = 0;
+
+		// Tile IDs with the tileset offset applied, per layer
+		std::vector<u16> m_tiles;
+
+		mutable std::vector<Chunk> m_chunks;
 };
 
 } // namespace gk
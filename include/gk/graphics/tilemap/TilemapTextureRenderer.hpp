@@ -0,0 +1,113 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#ifndef GK_TILEMAPTEXTURERENDERER_HPP_
+#define GK_TILEMAPTEXTURERENDERER_HPP_
+
+#include <memory>
+#include <vector>
+
+#include "gk/core/Timer.hpp"
+#include "gk/gl/Drawable.hpp"
+#include "gk/gl/Shader.hpp"
+#include "gk/gl/VertexBuffer.hpp"
+#include "gk/graphics/tilemap/TilemapRenderer.hpp"
+#include "gk/graphics/Tileset.hpp"
+
+namespace gk {
+
+class Tilemap;
+
+// The tile IDs of each layer are stored in a texture with one texel per tile,
+// and each layer is drawn as a single quad: the fragment shader reads the ID
+// of the tile under the pixel and looks up the pixel in the tileset.
+//
+// Animations are resolved by the shader too, from the time and a table built
+// from the tileset, so animated tiles don't need any upload. Changing a tile
+// uploads only its texel.
+//
+// The textures are RGBA8 with the ID in the red and green channels, since
+// integer textures and texelFetch() aren't available with OpenGL 2.1.
+//
+// Maps larger than GL_MAX_TEXTURE_SIZE are drawn by a TilemapRenderer instead,
+// and then animated by the TilemapAnimator of the map.
+class TilemapTextureRenderer : public Drawable {
+	public:
+		TilemapTextureRenderer() = default;
+		TilemapTextureRenderer(TilemapTextureRenderer &&renderer);
+		~TilemapTextureRenderer();
+
+		TilemapTextureRenderer &operator=(TilemapTextureRenderer &&renderer);
+
+		void init(Tilemap *map, u16 mapWidth, u16 mapHeight, u8 mapLayers);
+
+		void updateTile(u8 layer, u16 tileX, u16 tileY, u16 id, Tilemap &map);
+
+		bool isFallbackUsed() const { return m_isFallbackUsed; }
+
+	private:
+		void draw(RenderTarget &target, RenderStates states) const override;
+
+		void createLayerTextures() const;
+		void createAnimationTable() const;
+		void createShader() const;
+
+		void uploadDirtyTiles() const;
+
+		void deleteTextures() const;
+
+		bool isTextureSizeSupported() const;
+		void enableFallback() const;
+
+		Tilemap *m_map = nullptr;
+
+		u16 m_width = 0;
+		u16 m_height = 0;
+		u8 m_layerCount = 0;
+
+		// Tile IDs with the tileset offset applied, per layer
+		std::vector<u16> m_tiles;
+		mutable std::vector<u32> m_dirtyTiles;
+
+		mutable std::vector<GLuint> m_layerTextures;
+
+		// See TilemapAnimationTable
+		mutable GLuint m_animationTable = 0;
+		mutable u16 m_animationTableHeight = 0;
+		mutable u32 m_animationPeriod = 0;
+
+		mutable std::unique_ptr<Shader> m_shader;
+		mutable std::unique_ptr<VertexBuffer> m_vbo;
+
+		mutable Timer m_timer;
+
+		mutable TilemapRenderer m_fallbackRenderer;
+		mutable bool m_isFallbackUsed = false;
+};
+
+} // namespace gk
+
+#endif // GK_TILEMAPTEXTURERENDERER_HPP_
@@ -36,6 +36,7 @@
 #include "gk/scene/controller/BehaviourController.hpp"
 #include "gk/scene/controller/LifetimeController.hpp"
 #include "gk/scene/controller/MovementController.hpp"
+#include "gk/scene/controller/UpdateRateController.hpp"
 
 // Components
 #include "gk/scene/component/BehaviourComponent.hpp"
@@ -45,6 +46,7 @@
 #include "gk/scene/component/LifetimeComponent.hpp"
 #include "gk/scene/component/MovementComponent.hpp"
 #include "gk/scene/component/PositionComponent.hpp"
+#include "gk/scene/component/UpdateRateComponent.hpp"
 
 // Movements
 #include "gk/scene/movement/EasyMovement.hpp"
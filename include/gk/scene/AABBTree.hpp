@@ -0,0 +1,198 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#ifndef GK_AABBTREE_HPP_
+#define GK_AABBTREE_HPP_
+
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "gk/core/IntTypes.hpp"
+#include "gk/core/Rect.hpp"
+
+namespace gk {
+
+class SceneObject;
+
+// Dynamic bounding volume hierarchy of rectangles, kept balanced with tree rotations.
+//
+// Leaf rectangles are enlarged by `margin`, so an object moving a few pixels
+// doesn't have to be moved in the tree each time.
+class AABBTree {
+	public:
+		AABBTree(float margin = 8.f) : m_margin(margin) {}
+
+		s32 insert(const FloatRect &rect, SceneObject *object);
+		void remove(s32 leaf);
+
+		// Returns false if rect still fits in the enlarged rectangle of the leaf, which isn't moved then
+		bool move(s32 leaf, const FloatRect &rect);
+
+		void clear();
+
+		// Calls func(leaf) for each leaf whose enlarged rectangle intersects rect
+		// The tree must not be modified by func
+		template<typename Func>
+		void query(const FloatRect &rect, Func &&func) const {
+			if (m_root == nullNode)
+				return;
+
+			s32 stack[maxStackSize];
+			u16 count = 0;
+			stack[count++] = m_root;
+
+			while (count) {
+				s32 index = stack[--count];
+
+				const Node &node = m_nodes[index];
+				if (!overlaps(node.rect, rect))
+					continue;
+
+				if (node.isLeaf()) {
+					func(index);
+				}
+				else {
+					stack[count++] = node.child1;
+					stack[count++] = node.child2;
+				}
+			}
+		}
+
+		// Calls func(leaf, maxDistance) for each leaf whose enlarged rectangle is
+		// crossed by the ray, func returning the new maximum distance of the ray.
+		// direction has to be normalized.
+		template<typename Func>
+		void raycast(const Vector2f &origin, const Vector2f &direction, float maxDistance, Func &&func) const {
+			if (m_root == nullNode)
+				return;
+
+			s32 stack[maxStackSize];
+			u16 count = 0;
+			stack[count++] = m_root;
+
+			while (count) {
+				s32 index = stack[--count];
+
+				const Node &node = m_nodes[index];
+
+				float distance;
+				if (!rayIntersection(node.rect, origin, direction, maxDistance, distance))
+					continue;
+
+				if (node.isLeaf()) {
+					maxDistance = func(index, maxDistance);
+				}
+				else {
+					stack[count++] = node.child1;
+					stack[count++] = node.child2;
+				}
+			}
+		}
+
+		SceneObject *object(s32 leaf) const { return m_nodes[leaf].object; }
+		const FloatRect &rect(s32 leaf) const { return m_nodes[leaf].rect; }
+
+		size_t size() const { return m_leafCount; }
+		s32 height() const { return m_root == nullNode ? 0 : m_nodes[m_root].height; }
+
+		float margin() const { return m_margin; }
+
+		// Inclusive, so an empty rect lying on the edge of the other one is intersecting
+		static bool overlaps(const FloatRect &rect1, const FloatRect &rect2) {
+			return std::max(rect1.x, rect2.x) <= std::min(rect1.x + rect1.sizeX, rect2.x + rect2.sizeX)
+			    && std::max(rect1.y, rect2.y) <= std::min(rect1.y + rect1.sizeY, rect2.y + rect2.sizeY);
+		}
+
+		// Distance along the ray to the rectangle, 0 if origin is inside it
+		static bool rayIntersection(const FloatRect &rect, const Vector2f &origin, const Vector2f &direction, float maxDistance, float &distance) {
+			float min = 0.f;
+			float max = maxDistance;
+
+			if (!clipRay(rect.x, rect.x + rect.sizeX, origin.x, direction.x, min, max)
+			 || !clipRay(rect.y, rect.y + rect.sizeY, origin.y, direction.y, min, max))
+				return false;
+
+			distance = min;
+			return true;
+		}
+
+	private:
+		static constexpr s32 nullNode = -1;
+
+		// Enough for any tree that fits in memory, since the tree is kept balanced
+		static constexpr u16 maxStackSize = 256;
+
+		struct Node {
+			FloatRect rect;
+
+			SceneObject *object = nullptr;
+
+			s32 parent = nullNode;  // Next free node if the node is free
+			s32 child1 = nullNode;
+			s32 child2 = nullNode;
+
+			s32 height = 0;         // 0 for leaves, -1 for free nodes
+
+			bool isLeaf() const { return child1 == nullNode; }
+		};
+
+		static bool clipRay(float rectMin, float rectMax, float origin, float direction, float &min, float &max) {
+			if (std::abs(direction) < 1e-9f)
+				return origin >= rectMin && origin <= rectMax;
+
+			float t1 = (rectMin - origin) / direction;
+			float t2 = (rectMax - origin) / direction;
+			if (t1 > t2)
+				std::swap(t1, t2);
+
+			min = std::max(min, t1);
+			max = std::min(max, t2);
+
+			return min <= max;
+		}
+
+		s32 allocateNode();
+		void freeNode(s32 node);
+
+		void insertLeaf(s32 leaf);
+		void removeLeaf(s32 leaf);
+
+		void fixUpwards(s32 node);
+		s32 balance(s32 node);
+
+		float m_margin;
+
+		std::vector<Node> m_nodes;
+		s32 m_root = nullNode;
+		s32 m_freeList = nullNode;
+
+		size_t m_leafCount = 0;
+};
+
+} // namespace gk
+
+#endif // GK_AABBTREE_HPP_
@@ -0,0 +1,158 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#ifndef GK_ARCHETYPE_HPP_
+#define GK_ARCHETYPE_HPP_
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include "gk/scene/ComponentType.hpp"
+
+namespace gk {
+
+// Storage of the components of the objects that have the same component set.
+//
+// Components are stored in chunks holding a fixed number of rows, with one
+// array per component type in each chunk, so going through objects that have
+// the same components reads contiguous memory. Each object owns a row, and
+// its components are moved to a row of another archetype when a component is
+// added to or removed from it.
+//
+// Chunks are never moved or freed, and freed rows are reused lowest first, so
+// live rows stay in the first chunks. Archetypes are shared by all the objects
+// and never destroyed.
+//
+// Rows are allocated and freed under a lock, so objects can be built from
+// several threads at once. A row must only be accessed by one thread at a time.
+class Archetype {
+	public:
+		struct Column {
+			u16 typeID;
+			u32 size;
+			u32 alignment;
+			size_t offset; ///< Of the array of this type in a chunk
+
+			void (*relocate)(void *to, void *from); ///< Move-constructs to from from, then destroys from
+			void (*destroy)(void *component);
+		};
+
+		struct Row {
+			u8 *chunk = nullptr;
+			u32 chunkIndex = 0;
+			u32 index = 0; ///< In the chunk
+		};
+
+		Archetype(const Archetype &) = delete;
+		Archetype &operator=(const Archetype &) = delete;
+
+		// Archetype with the components of this one plus the given type
+		template<typename T>
+		Archetype &with() {
+			static_assert(std::is_move_constructible<T>::value, "Components must be move-constructible");
+			return with(column<T>());
+		}
+
+		// Archetype with the components of this one except the given type
+		Archetype &without(u16 typeID);
+
+		Row allocate();
+		void free(const Row &row);
+
+		// column is the position of the type among the types of the archetype, sorted by ID
+		void *get(const Row &row, size_t column) const {
+			const Column &c = m_columns[column];
+			return row.chunk + c.offset + size_t(row.index) * c.size;
+		}
+
+		const ComponentSignature &signature() const { return m_signature; }
+		const std::vector<Column> &columns() const { return m_columns; }
+
+		u32 chunkCapacity() const { return m_chunkCapacity; }
+
+		// Number of rows in use
+		u32 size() const;
+
+		// Position of typeID among the types of signature, sorted by ID
+		static size_t columnIndex(const ComponentSignature &signature, u16 typeID) {
+			return typeID ? (signature << (signature.size() - typeID)).count() : 0;
+		}
+
+		// Archetype without any component, which has no row
+		static Archetype &empty();
+
+	private:
+		Archetype(const ComponentSignature &signature, std::vector<Column> &&columns);
+
+		Archetype &with(const Column &column);
+
+		Archetype &edge(u16 typeID, std::vector<Column> &&columns);
+
+		template<typename T>
+		static const Column &column() {
+			static const Column column{
+				ComponentType::id<T>(), sizeof(T), alignof(T), 0,
+				[] (void *to, void *from) {
+					new (to) T(std::move(*static_cast<T *>(from)));
+					static_cast<T *>(from)->~T();
+				},
+				[] (void *component) { static_cast<T *>(component)->~T(); }
+			};
+
+			return column;
+		}
+
+		struct ChunkDeleter {
+			size_t alignment;
+			void operator()(u8 *chunk) const { ::operator delete(chunk, std::align_val_t(alignment)); }
+		};
+
+		ComponentSignature m_signature;
+		std::vector<Column> m_columns;
+
+		u32 m_chunkCapacity = 0;
+		size_t m_chunkSize = 0;
+		size_t m_alignment = 1;
+
+		// Archetype reached by adding or removing each type, resolved on first use
+		std::atomic<Archetype *> m_edges[GK_MAX_COMPONENT_TYPES] = {};
+
+		mutable std::mutex m_mutex;
+
+		std::vector<std::unique_ptr<u8, ChunkDeleter>> m_chunks;
+		u32 m_rowCount = 0;
+
+		// Min-heap of the freed rows, as chunk index * capacity + index
+		std::vector<u32> m_freeRows;
+};
+
+} // namespace gk
+
+#endif // GK_ARCHETYPE_HPP_
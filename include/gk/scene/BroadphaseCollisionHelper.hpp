@@ -0,0 +1,132 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#ifndef GK_BROADPHASECOLLISIONHELPER_HPP_
+#define GK_BROADPHASECOLLISIONHELPER_HPP_
+
+#include <unordered_set>
+#include <vector>
+
+#include "gk/core/IntTypes.hpp"
+#include "gk/scene/CollisionHelper.hpp"
+
+namespace gk {
+
+class Scene;
+
+// Base class of the helpers only reporting the pairs whose hitboxes may overlap,
+// so the collision actions aren't called for distant objects.
+//
+// The broadphase is rebuilt at the beginning of each tick, with the hitboxes
+// enlarged by `margin` to account for the movement of the objects during the
+// tick. When the list belongs to a Scene, the objects gaining or losing a
+// hitbox until the next rebuild are kept aside: the added ones are tested
+// against every query, and the removed ones are filtered out of the results.
+class BroadphaseCollisionHelper : public CollisionHelper {
+	public:
+		BroadphaseCollisionHelper(float margin) : m_margin(margin) {}
+
+		void update(SceneObjectList &objects) override;
+
+		void addObject(SceneObject &object) override;
+		void removeObject(const SceneObject &object) override;
+
+		void forEachPair(SceneObject &object, SceneObjectList &objects, const PairFunction &func) override;
+
+		float margin() const { return m_margin; }
+
+	protected:
+		struct Candidate {
+			SceneObject *object;
+			SceneObject *parent; // nullptr for top-level objects
+		};
+
+		virtual void rebuild(SceneObjectList &objects) = 0;
+
+		// Adds the objects whose enlarged hitbox intersects rect, which is the current hitbox of object
+		virtual void findCandidates(const SceneObject &object, const FloatRect &rect, std::vector<Candidate> &candidates) = 0;
+
+		// Calls func(object, parent, rect) for the top-level objects and their
+		// children having a hitbox, rect being the hitbox enlarged by the margin
+		template<typename Func>
+		void forEachHitbox(SceneObjectList &objects, Func &&func) {
+			for (SceneObject &object : objects) {
+				addHitbox(object, nullptr, func);
+
+				if (auto *children = object.tryGet<SceneObjectList>())
+					for (SceneObject &child : *children)
+						addHitbox(child, &object, func);
+			}
+		}
+
+	private:
+		template<typename Func>
+		void addHitbox(SceneObject &object, SceneObject *parent, Func &func) {
+			FloatRect rect;
+			if (getHitboxRect(object, rect)) {
+				rect.x -= m_margin;
+				rect.y -= m_margin;
+				rect.sizeX += m_margin * 2.f;
+				rect.sizeY += m_margin * 2.f;
+
+				func(object, parent, rect);
+			}
+		}
+
+		void sync(SceneObjectList &objects);
+
+		// Candidates of the subclass that are still in the broadphase, and the added objects overlapping rect
+		void findAllCandidates(const SceneObject &object, const FloatRect &rect);
+
+		// False if the object lost its hitbox or was removed since the last rebuild, without dereferencing it
+		bool isMember(const SceneObject *object) const;
+
+		float m_margin;
+
+		bool m_isBuilt = false;
+
+		Scene *m_scene = nullptr;
+
+		std::vector<SceneObject *> m_addedObjects;
+		std::unordered_set<const SceneObject *> m_removedObjects;
+		u32 m_changeCount = 0;
+
+		struct Pair {
+			SceneObject *object1;
+			SceneObject *object2;
+
+			// Slots are reused, so the handles tell if the objects were replaced
+			SceneObjectHandle handle1;
+			SceneObjectHandle handle2;
+		};
+
+		std::vector<Candidate> m_candidates;
+		std::vector<Pair> m_pairs;
+};
+
+} // namespace gk
+
+#endif // GK_BROADPHASECOLLISIONHELPER_HPP_
@@ -27,17 +27,50 @@
 #ifndef GK_COLLISIONHELPER_HPP_
 #define GK_COLLISIONHELPER_HPP_
 
-#include "gk/scene/SceneObject.hpp"
+#include <functional>
+
+#include "gk/core/Rect.hpp"
+#include "gk/scene/SceneObjectList.hpp"
 
 namespace gk {
 
 class CollisionHelper {
 	public:
+		using PairFunction = std::function<void(SceneObject &, SceneObject &)>;
+
 		virtual ~CollisionHelper() = default;
 
+		// Called by Scene once per tick, before the non-global controllers
+		virtual void update(SceneObjectList &) {}
+
+		// Called by Scene when one of its objects starts or stops having a position and a hitbox
+		virtual void addObject(SceneObject &) {}
+		virtual void removeObject(const SceneObject &) {}
+
+		// Calls func for each pair that has to be tested when object is checked,
+		// that is (object or one of its children, other object or one of its children).
+		// The default implementation returns every pair whose collision layers interact.
+		virtual void forEachPair(SceneObject &object, SceneObjectList &objects, const PairFunction &func);
+
+		void checkCollisionsFor(SceneObject &object, SceneObjectList &objects);
+
 		void checkCollision(SceneObject &object1, SceneObject &object2);
 
 		virtual bool inCollision(SceneObject &object1, SceneObject &object2);
+
+		// False if the collision layers of the hitboxes don't interact, or if both
+		// objects are resting. Objects without hitbox aren't filtered.
+		static bool canCollide(const SceneObject &object1, const SceneObject &object2);
+
+		// True if the hitbox of the object is static or if its movement is sleeping
+		static bool isResting(const SceneObject &object);
+
+		// Wakes the movement of the object up if it's sleeping
+		static void wakeUp(SceneObject &object);
+
+		// Hitbox in world coordinates, including the velocity of the object unless withVelocity is false
+		// Returns false if the object has no position or no current hitbox
+		static bool getHitboxRect(const SceneObject &object, FloatRect &rect, bool withVelocity = true);
 };
 
 } // namespace gk
@@ -0,0 +1,70 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#ifndef GK_COMPONENTTYPE_HPP_
+#define GK_COMPONENTTYPE_HPP_
+
+#include <bitset>
+#include <typeinfo>
+
+#include "gk/core/IntTypes.hpp"
+
+#ifndef GK_MAX_COMPONENT_TYPES
+#define GK_MAX_COMPONENT_TYPES 64
+#endif
+
+namespace gk {
+
+using ComponentSignature = std::bitset<GK_MAX_COMPONENT_TYPES>;
+
+// Gives each component type a small dense integer, assigned the first time
+// the type is used. These IDs index SceneObject signatures.
+class ComponentType {
+	public:
+		template<typename T>
+		static u16 id() {
+			static const u16 id = registerType(typeid(T).name());
+			return id;
+		}
+
+		static u16 count();
+
+		static const char *name(u16 id);
+
+	private:
+		static u16 registerType(const char *name);
+};
+
+template<typename... Components>
+ComponentSignature componentSignature() {
+	ComponentSignature signature;
+	(signature.set(ComponentType::id<Components>()), ...);
+	return signature;
+}
+
+} // namespace gk
+
+#endif // GK_COMPONENTTYPE_HPP_
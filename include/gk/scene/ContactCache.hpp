@@ -0,0 +1,94 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#ifndef GK_CONTACTCACHE_HPP_
+#define GK_CONTACTCACHE_HPP_
+
+#include <unordered_set>
+#include <vector>
+
+#include "gk/scene/component/CollisionComponent.hpp"
+#include "gk/scene/CollisionHelper.hpp"
+
+namespace gk {
+
+// Colliding pairs kept from one tick to the next, so the contact actions of
+// CollisionComponent are only called when a pair starts or stops colliding.
+// Pairs are only tracked if one of the objects has contact actions.
+class ContactCache {
+	public:
+		// Finds the colliding pairs with helper, then calls the exit actions of the
+		// pairs that ended, and the enter and stay actions of the current pairs.
+		// Pairs involving a removed object end without calling the exit actions.
+		void update(CollisionHelper &helper, SceneObjectList &objects);
+
+		// Called by Scene when an object is unregistered
+		void removeObject(const SceneObject &object);
+
+		size_t size() const { return m_contacts.size(); }
+
+	private:
+		// Object and generation of its handle, since the address is reused by the list
+		struct ObjectKey {
+			SceneObject *object;
+			u32 generation;
+
+			bool operator==(const ObjectKey &key) const { return object == key.object && generation == key.generation; }
+		};
+
+		struct Contact {
+			ObjectKey object1;
+			ObjectKey object2;
+
+			bool operator==(const Contact &contact) const { return object1 == contact.object1 && object2 == contact.object2; }
+		};
+
+		struct Hash {
+			size_t operator()(const ObjectKey &key) const;
+			size_t operator()(const Contact &contact) const;
+		};
+
+		using ContactActions = void (CollisionComponent::*)(SceneObject &, SceneObject &);
+
+		void addContact(SceneObject &object1, SceneObject &object2);
+
+		void callActions(const Contact &contact, ContactActions actions) const;
+
+		bool isAlive(const ObjectKey &key) const { return m_removedObjects.count(key) == 0; }
+
+		std::vector<Contact> m_contacts;
+		std::unordered_set<Contact, Hash> m_contactSet;
+
+		std::vector<Contact> m_newContacts;
+		std::unordered_set<Contact, Hash> m_newContactSet;
+
+		// Objects removed since the last update, which must not be accessed anymore
+		std::unordered_set<ObjectKey, Hash> m_removedObjects;
+};
+
+} // namespace gk
+
+#endif // GK_CONTACTCACHE_HPP_
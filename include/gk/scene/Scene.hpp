@@ -29,19 +29,34 @@
 
 #include <functional>
 #include <list>
+#include <unordered_map>
 
+#include "gk/core/ThreadPool.hpp"
 #include "gk/gl/Drawable.hpp"
 #include "gk/scene/controller/AbstractController.hpp"
 #include "gk/scene/view/AbstractView.hpp"
+#include "gk/scene/AABBTree.hpp"
 #include "gk/scene/CollisionHelper.hpp"
+#include "gk/scene/ContactCache.hpp"
+#include "gk/scene/SceneCommandBuffer.hpp"
 #include "gk/scene/SceneObject.hpp"
 #include "gk/scene/SceneObjectList.hpp"
+#include "gk/scene/SceneProfiler.hpp"
+#include "gk/scene/SceneQuery.hpp"
 
 namespace gk {
 
+struct RaycastHit {
+	SceneObject *object = nullptr;
+	float distance = 0.f;
+};
+
 class Scene : public Drawable {
 	public:
 		Scene();
+		Scene(const Scene &) = delete;
+
+		Scene &operator=(const Scene &) = delete;
 
 		void reset();
 		void update();
@@ -57,16 +72,43 @@ class Scene : public Drawable {
 		SceneObjectList &objects() { return m_objects; }
 		const SceneObjectList &objects() const { return m_objects; }
 
+		// Structural changes to apply after the global controllers or at the end of the update.
+		// Parallel tasks get their own buffer, appended to this one in task order after
+		// their wave, so the changes don't depend on the scheduling.
+		SceneCommandBuffer &commands();
+
+		template<typename... Components>
+		SceneQuery &query() { return query(ComponentFilter{componentSignature<Components...>(), {}}); }
+		SceneQuery &query(const ComponentFilter &filter);
+
+		// Objects whose hitbox intersects rect
+		// The first call builds a tree of the hitboxes, which is then updated once per tick
+		std::vector<SceneObject *> queryRegion(const FloatRect &rect);
+		void queryRegion(const FloatRect &rect, std::vector<SceneObject *> &objects);
+
+		// Closest object whose hitbox is crossed by the ray, if any
+		RaycastHit raycast(const Vector2f &origin, const Vector2f &direction, float maxDistance);
+
 		template<typename T, typename... Args>
 		auto addController(Args &&...args) -> typename std::enable_if<std::is_base_of<AbstractController, T>::value, T&>::type {
-			m_controllerList.emplace_back(new T(std::forward<Args>(args)...));
-			return *static_cast<T*>(m_controllerList.back().get());
+			T *controller = new T(std::forward<Args>(args)...);
+			m_controllerList.emplace_back(controller);
+
+			if (!controller->isGlobal() && !controller->filter().empty())
+				controller->m_query = &query(controller->filter());
+
+			return *controller;
 		}
 
 		template<typename T, typename... Args>
 		auto addView(Args &&...args) -> typename std::enable_if<std::is_base_of<AbstractView, T>::value, T&>::type {
-			m_viewList.emplace_back(new T(std::forward<Args>(args)...));
-			return *static_cast<T*>(m_viewList.back().get());
+			T *view = new T(std::forward<Args>(args)...);
+			m_viewList.emplace_back(view);
+
+			if (!view->filter().empty())
+				view->m_query = &query(view->filter());
+
+			return *view;
 		}
 
 		template<typename T, typename... Args>
@@ -75,19 +117,112 @@ class Scene : public Drawable {
 			return *static_cast<T*>(m_collisionHelper.get());
 		}
 
+		// Number of threads running the controllers that declare the components they
+		// access, including the one calling update(). Everything runs on the calling
+		// thread if 1, which is the default.
+		void setThreadCount(u16 threadCount);
+
+		// Times each controller, each view and the collision phase, at the cost of
+		// a clock read around each of them. profiler() is nullptr unless enabled.
+		// The collision phase is sampled as the collision helper: it includes the
+		// collision checks, which aren't counted in the time of the controllers.
+		// The flushes of the command buffer are sampled as SceneCommandBuffer.
+		void setProfilingEnabled(bool isEnabled);
+		SceneProfiler *profiler() { return m_profiler.get(); }
+
+		// Saves the positions at the beginning of each tick, so the views draw the
+		// objects between their last two positions, according to GameClock
+		void setInterpolationEnabled(bool isEnabled) { m_isInterpolationEnabled = isEnabled; }
+		bool isInterpolationEnabled() const { return m_isInterpolationEnabled; }
+
 		bool isActive() { return !m_controllerList.empty() || !m_viewList.empty(); }
 
 		void draw(const SceneObject &object, RenderTarget &target, RenderStates states) const;
 
 	private:
+		friend class SceneObject;
+		friend class SceneObjectList;
+		friend class SceneSnapshot;
+
 		void draw(RenderTarget &target, RenderStates states) const override;
 
+		void registerObject(SceneObject &object, SceneObject *parent);
+		void unregisterObject(SceneObject &object);
+		void updateQueries(SceneObject &object, const ComponentSignature &oldSignature);
+
+		// Called when snapshot objects got back their saved insertion index
+		void restoreInsertionIndices(u64 nextInsertionIndex);
+
+		void attach(SceneObjectList &objects, SceneObject *parent);
+		void detach(SceneObjectList &objects);
+
+		// Returns the number of objects visited
+		size_t updateController(AbstractController &controller);
+		void updateInParallel();
+
+		// Calls func, which returns the number of objects visited, and records its duration if profiling is enabled
+		template<typename T, typename Func>
+		void profile(const T &system, Func &&func) const;
+
+		// Calls func and adds its duration to the collision phase if profiling is enabled
+		template<typename Func>
+		void timeCollisions(Func &&func);
+
+		// Both flushes of a tick are sampled together as the command buffer
+		void flushCommands();
+
+		void updateTree();
+		void updateTreeLeaf(SceneObject &object);
+
+		// Declared before the objects, which unregister themselves when destroyed
+		std::list<SceneQuery> m_queries;
+
+		AABBTree m_tree;
+		std::unordered_map<const SceneObject *, s32> m_treeLeaves;
+		bool m_isTreeEnabled = false;
+		bool m_isTreeUpToDate = false;
+
+		// Objects found in the tree by draw(), sorted before being drawn
+		mutable std::vector<const SceneObject *> m_visibleObjects;
+
+		ContactCache m_contactCache;
+
+		// Also notified by the objects when they're destroyed
+		std::unique_ptr<CollisionHelper> m_collisionHelper;
+
 		SceneObjectList m_objects;
+		u64 m_nextInsertionIndex = 0;
+
+		SceneCommandBuffer m_commands;
 
 		std::list<std::unique_ptr<AbstractController>> m_controllerList;
 		std::list<std::unique_ptr<AbstractView>> m_viewList;
 
-		std::unique_ptr<CollisionHelper> m_collisionHelper;
+		struct ParallelTask {
+			AbstractController *controller;
+
+			size_t begin;      // Range of m_parallelObjects
+			size_t end;
+
+			bool hasChildren;  // If true, the child list of each object is passed to the controller too
+
+			SceneProfiler::Clock::duration duration;
+			SceneProfiler::Clock::duration collisionDuration;
+		};
+
+		std::unique_ptr<ThreadPool> m_threadPool;
+
+		std::vector<AbstractController *> m_parallelControllers;
+		std::vector<u16> m_controllerWaves;
+		std::vector<SceneObject *> m_parallelObjects;
+		std::vector<ParallelTask> m_parallelTasks;
+		std::vector<SceneCommandBuffer> m_taskCommands;
+
+		std::unique_ptr<SceneProfiler> m_profiler;
+		SceneProfiler::Clock::duration m_collisionTime{};
+		SceneProfiler::Clock::duration m_flushTime{};
+
+		bool m_isInterpolationEnabled = false;
 };
 
 } // namespace gk
@@ -0,0 +1,103 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#ifndef GK_SCENECOMMANDBUFFER_HPP_
+#define GK_SCENECOMMANDBUFFER_HPP_
+
+#include <functional>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "gk/scene/SceneObject.hpp"
+
+namespace gk {
+
+class SceneObjectList;
+
+// Structural changes recorded while the objects are being iterated, and
+// applied later at once. Scene flushes its buffer after the global
+// controllers and at the end of each update.
+//
+// A buffer is only recorded from one thread at a time: parallel controllers
+// get one buffer per task, see Scene::commands(). Objects can be built from
+// any thread, since rows of archetypes are allocated under a lock. The objects
+// the commands refer to must stay in their list until the buffer is flushed.
+class SceneCommandBuffer {
+	public:
+		void spawn(SceneObjectList &list, SceneObject &&object);
+
+		// The object is flagged right away, see SceneObject::isDestroyed()
+		void destroy(SceneObject &object);
+
+		template<typename T, typename... Args>
+		void set(SceneObject &object, Args &&...args) {
+			addCommand([&object, args = std::make_tuple(std::forward<Args>(args)...)] () mutable {
+				std::apply([&object] (auto &&...args) {
+					object.set<T>(std::forward<decltype(args)>(args)...);
+				}, std::move(args));
+			});
+		}
+
+		template<typename T>
+		void remove(SceneObject &object) {
+			addCommand([&object] { object.remove<T>(); });
+		}
+
+		bool empty() const;
+
+		// Moves the commands of buffer after the ones of this buffer
+		void append(SceneCommandBuffer &buffer);
+
+		// Applies the component changes, then the spawns, then removes the destroyed
+		// objects from objects and its child lists with a single pass over each list
+		void flush(SceneObjectList &objects);
+
+	private:
+		void addCommand(std::function<void()> &&command);
+
+		struct Spawn {
+			SceneObjectList *list;
+
+			// Object the list is the child list of, if attached to a scene. The list
+			// is found again from it, since it moves if the parent's components change.
+			SceneObject *parent;
+
+			SceneObject object;
+		};
+
+		std::vector<std::function<void()>> m_commands;
+		std::vector<Spawn> m_spawns;
+		size_t m_destroyedCount = 0;
+
+		// Kept to reuse their memory
+		std::vector<std::function<void()>> m_flushedCommands;
+		std::vector<Spawn> m_flushedSpawns;
+};
+
+} // namespace gk
+
+#endif // GK_SCENECOMMANDBUFFER_HPP_
@@ -27,51 +27,169 @@
 #ifndef GK_SCENEOBJECT_HPP_
 #define GK_SCENEOBJECT_HPP_
 
-#include <memory>
-#include <typeindex>
-#include <unordered_map>
+#include <vector>
 
 #include "gk/core/Exception.hpp"
+#include "gk/scene/Archetype.hpp"
+#include "gk/scene/ComponentType.hpp"
+#include "gk/scene/SceneObjectHandle.hpp"
 
 namespace gk {
 
+class Scene;
+
+// Components are stored in the Archetype of the component set of the object.
+// References returned by get() and set() stay valid while the object is moved,
+// but not after a component is added to or removed from the same object.
+//
+// An object in a SceneObjectList can't be moved or assigned, since its name and
+// type are indexed by the list: remove it and add the new object instead.
 class SceneObject {
 	public:
 		SceneObject(const std::string &name = "null", const std::string &type = "null")
 			: m_name(name), m_type(type) {}
 
+		SceneObject(const SceneObject &) = delete;
+		SceneObject(SceneObject &&object)
+			: m_name(std::move(checkUnlisted(object).m_name)), m_type(std::move(object.m_type)),
+			  m_signature(object.m_signature), m_archetype(object.m_archetype), m_row(object.m_row),
+			  m_isDestroyed(object.m_isDestroyed)
+		{
+			object.m_signature.reset();
+			object.m_archetype = nullptr;
+
+			if (object.m_scene)
+				object.updateQueries(m_signature);
+		}
+
+		~SceneObject() {
+			if (m_scene)
+				unregister();
+
+			clear();
+		}
+
+		SceneObject &operator=(const SceneObject &) = delete;
+		SceneObject &operator=(SceneObject &&object);
+
 		template<typename T, typename... Args>
 		T &set(Args &&...args) {
-			m_components[typeid(T).hash_code()] = std::make_shared<T>(std::forward<Args>(args)...);
-			return get<T>();
+			u16 id = ComponentType::id<T>();
+			ComponentSignature oldSignature = m_signature;
+
+			T *component;
+			if (m_signature[id]) {
+				// Built first, since the arguments may refer to the replaced component
+				T newComponent(std::forward<Args>(args)...);
+
+				component = static_cast<T *>(data(id));
+				component->~T();
+				new (component) T(std::move(newComponent));
+			}
+			else {
+				Archetype *oldArchetype = m_archetype;
+				Archetype::Row oldRow = m_row;
+
+				Archetype &archetype = (m_archetype ? *m_archetype : Archetype::empty()).with<T>();
+				Archetype::Row row = archetype.allocate();
+
+				// The type has the same position in the new archetype as in the signature before it's set
+				component = static_cast<T *>(archetype.get(row, index(id)));
+
+				try {
+					new (component) T(std::forward<Args>(args)...);
+				}
+				catch (...) {
+					archetype.free(row);
+					throw;
+				}
+
+				moveComponents(&archetype, row);
+				m_signature.set(id);
+
+				if (oldArchetype)
+					oldArchetype->free(oldRow);
+			}
+
+			if (m_scene)
+				updateQueries(oldSignature);
+
+			return *component;
 		}
 
 		template<typename T>
 		bool has() const {
-			return m_components.count(typeid(T).hash_code()) == 1;
+			return m_signature[ComponentType::id<T>()];
+		}
+
+		template<typename T>
+		T *tryGet() const {
+			u16 id = ComponentType::id<T>();
+			if (!m_signature[id])
+				return nullptr;
+
+			return static_cast<T *>(data(id));
 		}
 
 		template<typename T>
 		T &get() const {
-			auto it = m_components.find(typeid(T).hash_code());
-			if(it == m_components.end()) {
+			T *component = tryGet<T>();
+			if(!component) {
 				throw EXCEPTION("SceneObject", (void*)this, "(\"" + m_name + "\", \"" + m_type + "\") doesn't have a component of type:", typeid(T).name());
 			}
 
-			return *std::static_pointer_cast<T>(it->second);
+			return *component;
 		}
 
 		template<typename T>
 		void remove() {
-			m_components.erase(typeid(T).hash_code());
+			u16 id = ComponentType::id<T>();
+			if (m_signature[id]) {
+				Archetype *oldArchetype = m_archetype;
+				Archetype::Row oldRow = m_row;
+
+				// Destroyed once the queries are updated
+				T *component = static_cast<T *>(data(id));
+
+				ComponentSignature oldSignature = m_signature;
+				m_signature.reset(id);
+
+				if (m_signature.any()) {
+					Archetype &archetype = oldArchetype->without(id);
+					moveComponents(&archetype, archetype.allocate());
+				}
+				else {
+					moveComponents(nullptr, {});
+				}
+
+				if (m_scene)
+					updateQueries(oldSignature);
+
+				component->~T();
+				oldArchetype->free(oldRow);
+			}
 		}
 
+		const ComponentSignature &signature() const { return m_signature; }
+
+		Scene *scene() const { return m_scene; }
+
+		// Object whose child list contains this one, nullptr for the top-level objects of a scene
+		SceneObject *parent() const { return m_parent; }
+
+		// Handle of the object in the SceneObjectList it was added to
+		SceneObjectHandle handle() const { return m_handle; }
+
+		// True if the object will be removed when its SceneCommandBuffer is flushed
+		bool isDestroyed() const { return m_isDestroyed; }
+
 		void debug() const {
 			gkDebug() << "=== Component list of object:" << (void*)this << "===";
-			gkDebug() << "=== List address:" << (void*)&m_components;
+			gkDebug() << "=== Chunk address:" << (void*)m_row.chunk;
 
-			for(auto &it : m_components) {
-				gkDebug() << it.first << ":" << (void*)it.second.get();
+			for (u16 id = 0 ; id < m_signature.size() ; ++id) {
+				if (m_signature[id])
+					gkDebug() << ComponentType::name(id) << ":" << data(id);
 			}
 
 			gkDebug() << "=== End of list. ===";
@@ -81,10 +199,49 @@ class SceneObject {
 		const std::string &type() const { return m_type; }
 
 	private:
+		friend class Scene;
+		friend class SceneCommandBuffer;
+		friend class SceneObjectList;
+		friend class SceneQuery;
+		friend class SceneSnapshot;
+
+		// Defined in SceneObject.cpp, since they need the full Scene class
+		void updateQueries(const ComponentSignature &oldSignature);
+		void unregister();
+
+		// Moves the components that archetype has to row, which becomes the row
+		// of the object. The previous row isn't freed.
+		void moveComponents(Archetype *archetype, const Archetype::Row &row);
+
+		void clear();
+
+		// Throws if the object is in a SceneObjectList, otherwise returns it
+		static SceneObject &checkUnlisted(SceneObject &object);
+
+		// Columns of an archetype are sorted by type ID, so the position of a
+		// component is the number of lower IDs set in the signature
+		size_t index(u16 id) const { return Archetype::columnIndex(m_signature, id); }
+
+		void *data(u16 id) const { return m_archetype->get(m_row, index(id)); }
+
 		std::string m_name;
 		std::string m_type;
 
-		std::unordered_map<size_t, std::shared_ptr<void>> m_components;
+		ComponentSignature m_signature;
+
+		// nullptr if the object has no component
+		Archetype *m_archetype = nullptr;
+		Archetype::Row m_row;
+
+		Scene *m_scene = nullptr;
+		SceneObject *m_parent = nullptr;
+
+		SceneObjectHandle m_handle;
+
+		// Order in which the object was registered in its scene, queries are sorted by it
+		u64 m_insertionIndex = 0;
+
+		bool m_isDestroyed = false;
 };
 
 } // namespace gk
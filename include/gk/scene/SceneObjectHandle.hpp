@@ -0,0 +1,48 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#ifndef GK_SCENEOBJECTHANDLE_HPP_
+#define GK_SCENEOBJECTHANDLE_HPP_
+
+#include "gk/core/IntTypes.hpp"
+
+namespace gk {
+
+// Reference to an object of a SceneObjectList, which can be checked after the
+// object is removed: the generation of a slot changes each time it's freed.
+struct SceneObjectHandle {
+	u32 index = ~0u;
+	u32 generation = 0;
+
+	bool isValid() const { return index != ~0u; }
+
+	bool operator==(const SceneObjectHandle &handle) const { return index == handle.index && generation == handle.generation; }
+	bool operator!=(const SceneObjectHandle &handle) const { return !operator==(handle); }
+};
+
+} // namespace gk
+
+#endif // GK_SCENEOBJECTHANDLE_HPP_
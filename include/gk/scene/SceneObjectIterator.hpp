@@ -0,0 +1,69 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#ifndef GK_SCENEOBJECTITERATOR_HPP_
+#define GK_SCENEOBJECTITERATOR_HPP_
+
+#include <iterator>
+#include <vector>
+
+namespace gk {
+
+class SceneObject;
+
+// Iterates over a vector of object pointers, skipping null entries
+template<typename T>
+class SceneObjectIterator {
+	using BaseIterator = std::vector<SceneObject *>::const_iterator;
+
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = T;
+		using difference_type = std::ptrdiff_t;
+		using pointer = T *;
+		using reference = T &;
+
+		SceneObjectIterator(BaseIterator it, BaseIterator end) : m_it(it), m_end(end) { skipNull(); }
+
+		reference operator*() const { return **m_it; }
+		pointer operator->() const { return *m_it; }
+
+		SceneObjectIterator &operator++() { ++m_it; skipNull(); return *this; }
+		SceneObjectIterator operator++(int) { SceneObjectIterator it = *this; ++*this; return it; }
+
+		bool operator==(const SceneObjectIterator &it) const { return m_it == it.m_it; }
+		bool operator!=(const SceneObjectIterator &it) const { return m_it != it.m_it; }
+
+	private:
+		void skipNull() { while (m_it != m_end && !*m_it) ++m_it; }
+
+		BaseIterator m_it;
+		BaseIterator m_end;
+};
+
+} // namespace gk
+
+#endif // GK_SCENEOBJECTITERATOR_HPP_
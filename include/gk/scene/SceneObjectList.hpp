@@ -27,53 +27,125 @@
 #ifndef GK_SCENEOBJECTLIST_HPP_
 #define GK_SCENEOBJECTLIST_HPP_
 
-#include <algorithm>
 #include <deque>
+#include <unordered_map>
 
 #include "gk/scene/SceneObject.hpp"
+#include "gk/scene/SceneObjectIterator.hpp"
 
 namespace gk {
 
+// Objects are stored in slots that are reused after removal, so an object
+// never moves in memory while it's in the list. The objects are kept in the
+// order they were added, which is the order views draw them in. Removing an
+// object leaves an empty entry behind, and the following objects are only
+// shifted by the next access by index or removeDestroyedObjects(), in a single
+// pass for all the objects removed since.
 class SceneObjectList {
-	using iterator = std::deque<SceneObject>::iterator;
-	using const_iterator = std::deque<SceneObject>::const_iterator;
+	using iterator = SceneObjectIterator<SceneObject>;
+	using const_iterator = SceneObjectIterator<const SceneObject>;
 
 	public:
-		SceneObject &addObject(SceneObject &&object) {
-			m_objects.emplace_back(std::move(object));
-			return m_objects.back();
+		SceneObjectList() = default;
+		SceneObjectList(const SceneObjectList &) = delete;
+		SceneObjectList(SceneObjectList &&list);
+
+		SceneObjectList &operator=(const SceneObjectList &) = delete;
+		SceneObjectList &operator=(SceneObjectList &&list);
+
+		// Use SceneObject::handle() to keep a reference that can be checked later
+		SceneObject &addObject(SceneObject &&object);
+
+		// Returns nullptr if the object was removed
+		SceneObject *get(SceneObjectHandle handle);
+		const SceneObject *get(SceneObjectHandle handle) const;
+
+		// Returns one of the objects with this name
+		SceneObject *findByName(const std::string &name);
+
+		// Objects must not be added or removed by func
+		template<typename Func>
+		void forEachOfType(const std::string &type, Func &&func) {
+			auto it = m_typeIndex.find(type);
+			if (it != m_typeIndex.end())
+				for (u32 slot : it->second)
+					func(m_storage[slot]);
 		}
 
-		SceneObject *findByName(const std::string &name) {
-			auto it = std::find_if(m_objects.begin(), m_objects.end(), [name] (SceneObject &object) { return object.name() == name; });
-			if (it == m_objects.end())
-				return nullptr;
-			else
-				return &*it;
-		}
+		void removeByName(const std::string &name);
 
-		void removeByName(const std::string &name) {
-			auto it = std::find_if(m_objects.begin(), m_objects.end(), [name] (SceneObject &object) { return object.name() == name; });
-			if (it != m_objects.end())
-				m_objects.erase(it);
-		}
+		void pop() { remove(size() - 1); }
+
+		SceneObject &operator[](size_t n) { compact(); return *m_objects[n]; }
+		const SceneObject &operator[](size_t n) const { compact(); return *m_objects[n]; }
 
-		void pop() { m_objects.pop_back(); }
+		void remove(size_t n);
+		void remove(SceneObjectHandle handle);
 
-		SceneObject &operator[](size_t n) { return m_objects[n]; }
+		// Removes the destroyed objects, from this list and the child lists, in a single pass
+		void removeDestroyedObjects();
 
-		void remove(size_t n) { m_objects.erase(m_objects.begin() + n); }
+		iterator begin() noexcept { return {m_objects.begin(), m_objects.end()}; }
+		iterator end() noexcept { return {m_objects.end(), m_objects.end()}; }
 
-		iterator begin() noexcept { return m_objects.begin(); }
-		iterator end() noexcept { return m_objects.end(); }
+		const_iterator begin() const noexcept { return {m_objects.begin(), m_objects.end()}; }
+		const_iterator end() const noexcept { return {m_objects.end(), m_objects.end()}; }
 
-		const_iterator begin() const noexcept { return m_objects.begin(); }
-		const_iterator end() const noexcept { return m_objects.end(); }
+		size_t size() const { return m_objects.size() - m_holeCount; }
 
-		size_t size() const { return m_objects.size(); }
+		Scene *scene() const { return m_scene; }
 
 	private:
-		std::deque<SceneObject> m_objects;
+		friend class Scene;
+		friend class SceneCommandBuffer;
+		friend class SceneSnapshot;
+
+		struct Slot {
+			u32 generation = 0;
+
+			mutable u32 position = 0; // In m_objects, updated by compact()
+			u32 namePosition = 0;     // In the bucket of the name index
+			u32 typePosition = 0;     // In the bucket of the type index
+		};
+
+		using Index = std::unordered_map<std::string, std::vector<u32>>;
+
+		void addToIndex(Index &index, const std::string &key, u32 slot, u32 Slot::*position);
+		void removeFromIndex(Index &index, const std::string &key, u32 slot, u32 Slot::*position);
+
+		// Removes the object at this position in m_objects, leaving an empty entry
+		void removeAt(u32 position);
+
+		void release(SceneObject &object);
+
+		// Removes the empty entries, which doesn't change the objects or their order
+		void compact() const { if (m_holeCount != 0) removeHoles(); }
+		void removeHoles() const;
+
+		// Used to restore snapshots: adds an object with a given handle, replacing the
+		// object in its slot if any, then keeps only the given objects in this order.
+		// The free slots are only valid again after retain().
+		SceneObject &addObject(SceneObject &&object, SceneObjectHandle handle);
+		void retain(const std::vector<SceneObject *> &objects);
+
+		// Sets the slot count and the free slots, which must not be used by an object
+		void setFreeSlots(u32 slotCount, const std::vector<SceneObjectHandle> &freeSlots);
+
+		// Changes the name and type of an object of the list, keeping the indices up to date
+		void rename(SceneObject &object, const std::string &name, const std::string &type);
+
+		std::deque<SceneObject> m_storage;
+		std::vector<Slot> m_slots;
+		std::vector<u32> m_freeSlots;
+
+		mutable std::vector<SceneObject *> m_objects;
+		mutable u32 m_holeCount = 0;
+
+		Index m_nameIndex;
+		Index m_typeIndex;
+
+		Scene *m_scene = nullptr;
+		SceneObject *m_parent = nullptr; // Object this list is the child list of, if attached to a scene
 };
 
 } // namespace gk
@@ -0,0 +1,95 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#ifndef GK_SCENEPROFILER_HPP_
+#define GK_SCENEPROFILER_HPP_
+
+#include <chrono>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+#include "gk/core/IntTypes.hpp"
+
+namespace gk {
+
+// Rolling timings of the systems of a Scene: each controller, each view and the collision phase
+class SceneProfiler {
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		// Times are in microseconds, over the last samples of the system
+		struct Stats {
+			std::string name;
+
+			u32 sampleCount = 0;
+			u64 objectCount = 0; // Objects visited during the last sample
+
+			float lastTime = 0.f;
+			float minTime = 0.f;
+			float averageTime = 0.f;
+			float p99Time = 0.f;
+		};
+
+		// A system is identified by its address, its name is taken from type
+		void addSample(const void *system, const std::type_info &type, Clock::duration duration, u64 objectCount);
+
+		// Called by Scene at the end of each update, to log the stats periodically
+		void endTick();
+
+		std::vector<Stats> stats() const;
+
+		void log() const;
+
+		void clear();
+
+		// Stats are logged every logInterval ticks, never if 0 which is the default
+		void setLogInterval(u32 logInterval) { m_logInterval = logInterval; }
+
+	private:
+		static const size_t maxSampleCount = 256;
+
+		struct System {
+			std::string name;
+
+			std::vector<float> samples; // Ring buffer of the last times
+			size_t nextSample = 0;
+
+			u64 objectCount = 0;
+			float lastTime = 0.f;
+		};
+
+		std::vector<System> m_systems;
+		std::unordered_map<const void *, size_t> m_systemIndices;
+
+		u32 m_logInterval = 0;
+		u32 m_tickCount = 0;
+};
+
+} // namespace gk
+
+#endif // GK_SCENEPROFILER_HPP_
@@ -0,0 +1,125 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#ifndef GK_SCENEQUERY_HPP_
+#define GK_SCENEQUERY_HPP_
+
+#include <unordered_map>
+
+#include "gk/scene/ComponentType.hpp"
+#include "gk/scene/SceneObjectIterator.hpp"
+
+namespace gk {
+
+struct ComponentFilter {
+	ComponentSignature all; ///< Components an object must all have
+	ComponentSignature any; ///< Components an object must have at least one of, ignored if empty
+
+	bool empty() const { return all.none() && any.none(); }
+
+	bool matches(const ComponentSignature &signature) const {
+		return (signature & all) == all && (any.none() || (signature & any).any());
+	}
+
+	bool operator==(const ComponentFilter &filter) const { return all == filter.all && any == filter.any; }
+	bool operator!=(const ComponentFilter &filter) const { return !operator==(filter); }
+};
+
+// Set of the scene objects matching a ComponentFilter, kept up to date by
+// Scene when objects are added, removed, or have their components changed.
+//
+// Objects are kept in the order they were added to the scene, which is the
+// order views draw them in. Removed objects leave an empty entry behind until
+// the next forEach(), and objects that start matching after a newer one are
+// only moved to their place then, so the query can be modified while it's
+// being iterated.
+class SceneQuery {
+	using iterator = SceneObjectIterator<SceneObject>;
+
+	public:
+		SceneQuery(const ComponentFilter &filter) : m_filter(filter) {}
+
+		template<typename Func>
+		void forEach(Func &&func) {
+			if (m_iterationDepth == 0 && (m_holeCount != 0 || m_isSortNeeded))
+				compact();
+
+			++m_iterationDepth;
+
+			for (size_t i = 0 ; i < m_objects.size() ; ++i)
+				if (m_objects[i])
+					func(*m_objects[i]);
+
+			--m_iterationDepth;
+		}
+
+		iterator begin() const { return {m_objects.begin(), m_objects.end()}; }
+		iterator end() const { return {m_objects.end(), m_objects.end()}; }
+
+		size_t size() const { return m_indices.size(); }
+
+		bool contains(const SceneObject &object) const { return m_indices.count(&object) == 1; }
+
+		const ComponentFilter &filter() const { return m_filter; }
+
+		// Incremented each time an object is added to or removed from the query
+		u32 version() const { return m_version; }
+
+		// If enabled, the objects added to the query are also kept until they're taken,
+		// so a controller can only visit the new objects. Objects removed since then
+		// are still in the list, so they must be checked with contains().
+		void setAddedObjectsTracked(bool isTracked) { m_isTrackingAddedObjects = isTracked; m_addedObjects.clear(); }
+
+		// Replaces objects with the objects added since the last call
+		void takeAddedObjects(std::vector<SceneObject *> &objects) { objects.clear(); objects.swap(m_addedObjects); }
+
+	private:
+		friend class Scene;
+
+		void add(SceneObject &object);
+		void remove(const SceneObject &object);
+
+		void compact();
+
+		ComponentFilter m_filter;
+
+		std::vector<SceneObject *> m_objects;
+		std::unordered_map<const SceneObject *, size_t> m_indices;
+
+		size_t m_holeCount = 0;
+		bool m_isSortNeeded = false;
+		u64 m_lastInsertionIndex = 0;
+		u16 m_iterationDepth = 0;
+
+		u32 m_version = 0;
+
+		bool m_isTrackingAddedObjects = false;
+		std::vector<SceneObject *> m_addedObjects;
+};
+
+} // namespace gk
+
+#endif // GK_SCENEQUERY_HPP_
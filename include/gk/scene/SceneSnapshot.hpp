@@ -0,0 +1,188 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#ifndef GK_SCENESNAPSHOT_HPP_
+#define GK_SCENESNAPSHOT_HPP_
+
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "gk/core/Exception.hpp"
+#include "gk/scene/SceneObjectList.hpp"
+
+namespace gk {
+
+class SnapshotWriter {
+	public:
+		SnapshotWriter(std::vector<u8> &data) : m_data(data) {}
+
+		template<typename T>
+		void write(const T &value) {
+			static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be written directly");
+			writeBytes(&value, sizeof(T));
+		}
+
+		void write(const std::string &string) {
+			write(static_cast<u32>(string.size()));
+			writeBytes(string.data(), string.size());
+		}
+
+		void writeBytes(const void *data, size_t size) {
+			const u8 *bytes = static_cast<const u8 *>(data);
+			m_data.insert(m_data.end(), bytes, bytes + size);
+		}
+
+		size_t size() const { return m_data.size(); }
+
+		// Overwrites a value written before
+		template<typename T>
+		void patch(size_t offset, const T &value) {
+			std::memcpy(&m_data[offset], &value, sizeof(T));
+		}
+
+	private:
+		std::vector<u8> &m_data;
+};
+
+class SnapshotReader {
+	public:
+		SnapshotReader(const std::vector<u8> &data) : m_data(data) {}
+
+		template<typename T>
+		void read(T &value) {
+			static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be read directly");
+			readBytes(&value, sizeof(T));
+		}
+
+		void read(std::string &string) {
+			u32 size;
+			read(size);
+			check(size);
+			string.assign(reinterpret_cast<const char *>(&m_data[m_position]), size);
+			m_position += size;
+		}
+
+		void readBytes(void *data, size_t size) {
+			check(size);
+			std::memcpy(data, m_data.data() + m_position, size);
+			m_position += size;
+		}
+
+		void skip(size_t size) {
+			check(size);
+			m_position += size;
+		}
+
+		size_t position() const { return m_position; }
+
+	private:
+		void check(size_t size) const {
+			if (size > m_data.size() - m_position)
+				throw EXCEPTION("Truncated scene snapshot: reading", size, "bytes at position", m_position, "of", m_data.size());
+		}
+
+		const std::vector<u8> &m_data;
+		size_t m_position = 0;
+};
+
+// Describes how a component type is stored in snapshots. The default one copies
+// the bytes of trivially copyable types, other types need a specialization.
+template<typename T>
+struct SnapshotTraits {
+	static_assert(std::is_trivially_copyable<T>::value, "Specialize gk::SnapshotTraits for this component type");
+
+	static void save(const T &component, SnapshotWriter &writer) {
+		writer.write(component);
+	}
+
+	// Restores the component of object, which may not have one yet
+	static void load(SceneObject &object, SnapshotReader &reader) {
+		if (T *component = object.tryGet<T>()) {
+			reader.read(*component);
+		}
+		else {
+			typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+			reader.readBytes(&storage, sizeof(T));
+			object.set<T>(*reinterpret_cast<const T *>(&storage));
+		}
+	}
+};
+
+// Binary copy of the objects of a list, their registered components and their
+// child lists. Restoring it into the same list reuses the objects and components
+// that still have the same handle instead of creating new ones. The other objects
+// are recreated in their slot with their insertion index, so the handles and the
+// drawing order are the same as when it was saved.
+class SceneSnapshot {
+	public:
+		// Only registered component types are saved. Restoring removes the registered
+		// components an object didn't have when saved, others are left untouched.
+		// Types must be registered in the same order by programs sharing snapshots.
+		template<typename T>
+		static void registerComponent() {
+			registerComponent({
+				ComponentType::id<T>(),
+				[] (const void *component, SnapshotWriter &writer) {
+					SnapshotTraits<T>::save(*static_cast<const T *>(component), writer);
+				},
+				[] (SceneObject &object, SnapshotReader &reader) {
+					SnapshotTraits<T>::load(object, reader);
+				},
+				[] (SceneObject &object) {
+					object.remove<T>();
+				}
+			});
+		}
+
+		void save(const SceneObjectList &objects);
+		void restore(SceneObjectList &objects) const;
+
+		const std::vector<u8> &data() const { return m_data; }
+		void setData(std::vector<u8> &&data) { m_data = std::move(data); }
+
+	private:
+		struct ComponentInfo {
+			u16 typeID;
+
+			void (*save)(const void *component, SnapshotWriter &writer);
+			void (*load)(SceneObject &object, SnapshotReader &reader);
+			void (*remove)(SceneObject &object);
+		};
+
+		static std::vector<ComponentInfo> &registeredComponents();
+		static void registerComponent(const ComponentInfo &info);
+
+		static void saveList(const SceneObjectList &objects, SnapshotWriter &writer);
+		static void restoreList(SceneObjectList &objects, SnapshotReader &reader);
+
+		std::vector<u8> m_data;
+};
+
+} // namespace gk
+
+#endif // GK_SCENESNAPSHOT_HPP_
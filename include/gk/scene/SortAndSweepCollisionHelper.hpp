@@ -0,0 +1,97 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#ifndef GK_SORTANDSWEEPCOLLISIONHELPER_HPP_
+#define GK_SORTANDSWEEPCOLLISIONHELPER_HPP_
+
+#include <unordered_map>
+
+#include "gk/scene/BroadphaseCollisionHelper.hpp"
+
+namespace gk {
+
+// Broadphase keeping the hitbox endpoints on the x axis in a sorted array.
+//
+// The array is kept between ticks and sorted again with an insertion sort,
+// which is close to linear since the objects only move a few pixels per tick.
+// Overlapping pairs are then found by sweeping it. Static hitboxes are only
+// tested against the other ones during the sweep, since two of them never collide.
+class SortAndSweepCollisionHelper : public BroadphaseCollisionHelper {
+	public:
+		SortAndSweepCollisionHelper(float margin = 8.f) : BroadphaseCollisionHelper(margin) {}
+
+	protected:
+		void rebuild(SceneObjectList &objects) override;
+
+		void findCandidates(const SceneObject &object, const FloatRect &rect, std::vector<Candidate> &candidates) override;
+
+	private:
+		struct Entry {
+			SceneObject *object;  // nullptr if the entry is free
+			SceneObject *parent;
+
+			FloatRect rect;
+
+			u32 stamp;            // Last rebuild the object was found in
+			u32 activeIndex;      // Position in m_active or m_activeStatic during the sweep
+
+			bool isStatic;
+		};
+
+		struct Endpoint {
+			float value;
+			u32 entry;            // Has endBit set for the right side of the hitbox
+
+			bool operator<(const Endpoint &endpoint) const {
+				// Starts come first, so touching hitboxes are reported too
+				return value < endpoint.value || (value == endpoint.value && !(entry & endBit) && (endpoint.entry & endBit));
+			}
+		};
+
+		static constexpr u32 endBit = 1u << 31;
+
+		void sweep();
+
+		std::vector<Entry> m_entries;
+		std::vector<u32> m_freeEntries;
+		std::unordered_map<const SceneObject *, u32> m_entryIndices;
+
+		std::vector<Endpoint> m_endpoints;
+
+		std::vector<u32> m_active;
+		std::vector<u32> m_activeStatic;
+		std::vector<std::pair<u32, u32>> m_overlaps;
+
+		std::vector<u32> m_neighbourStart; // Index of the first neighbour of each entry in m_neighbours
+		std::vector<u32> m_neighbours;
+		std::vector<u32> m_neighbourCursor;
+
+		u32 m_stamp = 0;
+};
+
+} // namespace gk
+
+#endif // GK_SORTANDSWEEPCOLLISIONHELPER_HPP_
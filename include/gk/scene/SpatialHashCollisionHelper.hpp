@@ -0,0 +1,88 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#ifndef GK_SPATIALHASHCOLLISIONHELPER_HPP_
+#define GK_SPATIALHASHCOLLISIONHELPER_HPP_
+
+#include "gk/scene/BroadphaseCollisionHelper.hpp"
+
+namespace gk {
+
+// Broadphase storing the hitboxes in a uniform grid, so an object is only
+// tested against the objects sharing a cell with it. Static hitboxes are kept
+// in a separate grid, only rebuilt when a static object is added, removed,
+// moved or has its hitbox changed.
+class SpatialHashCollisionHelper : public BroadphaseCollisionHelper {
+	public:
+		SpatialHashCollisionHelper(float cellSize = 64.f, float margin = 8.f);
+
+		float cellSize() const { return m_cellSize; }
+
+	protected:
+		void rebuild(SceneObjectList &objects) override;
+
+		void findCandidates(const SceneObject &object, const FloatRect &rect, std::vector<Candidate> &candidates) override;
+
+	private:
+		struct Entry {
+			SceneObject *object;
+			SceneObject *parent;
+
+			FloatRect rect;
+			s32 x1, y1, x2, y2;  // Covered cells, inclusive
+
+			u32 stamp;
+		};
+
+		struct Grid {
+			std::vector<Entry> entries;
+			std::vector<u32> largeEntries;  // Entries covering too many cells to be stored in the grid
+
+			std::vector<u32> bucketStart;   // Index of the first entry of each bucket in bucketEntries
+			std::vector<u32> bucketEntries;
+			std::vector<u32> bucketCursor;
+			u32 bucketMask = 0;
+		};
+
+		void build(Grid &grid);
+		void findCandidates(Grid &grid, const FloatRect &rect, std::vector<Candidate> &candidates);
+
+		s32 cellCoord(float coord) const;
+		u32 bucket(const Grid &grid, s32 x, s32 y) const;
+
+		float m_cellSize;
+
+		Grid m_grid;
+
+		// Objects with a static hitbox
+		Grid m_staticGrid;
+
+		u32 m_stamp = 0;
+};
+
+} // namespace gk
+
+#endif // GK_SPATIALHASHCOLLISIONHELPER_HPP_
@@ -37,6 +37,7 @@ namespace gk {
 class CollisionComponent {
 	using CollisionChecker = std::function<void(SceneObject&)>;
 	using CollisionAction  = std::function<void(SceneObject&, SceneObject&, bool)>;
+	using ContactAction    = std::function<void(SceneObject&, SceneObject&)>;
 
 	public:
 		void checkCollisions(SceneObject &object) {
@@ -59,10 +60,35 @@ class CollisionComponent {
 			m_actions.push_back(action);
 		}
 
+		// Contact actions are called by Scene once per tick, after the controllers,
+		// when the object starts colliding with another one, keeps colliding with
+		// it, or stops colliding with it
+		void addEnterAction(ContactAction action) { m_enterActions.push_back(action); }
+		void addStayAction(ContactAction action) { m_stayActions.push_back(action); }
+		void addExitAction(ContactAction action) { m_exitActions.push_back(action); }
+
+		void enterActions(SceneObject &object1, SceneObject &object2) { contactActions(m_enterActions, object1, object2); }
+		void stayActions(SceneObject &object1, SceneObject &object2) { contactActions(m_stayActions, object1, object2); }
+		void exitActions(SceneObject &object1, SceneObject &object2) { contactActions(m_exitActions, object1, object2); }
+
+		bool hasActions() const { return !m_actions.empty(); }
+		bool hasContactActions() const { return !m_enterActions.empty() || !m_stayActions.empty() || !m_exitActions.empty(); }
+		bool hasStayActions() const { return !m_stayActions.empty(); }
+
 	private:
+		void contactActions(std::vector<ContactAction> &actions, SceneObject &object1, SceneObject &object2) {
+			for(auto &it : actions) {
+				it(object1, object2);
+			}
+		}
+
 		std::vector<CollisionChecker> m_checkers;
 
 		std::vector<CollisionAction> m_actions;
+
+		std::vector<ContactAction> m_enterActions;
+		std::vector<ContactAction> m_stayActions;
+		std::vector<ContactAction> m_exitActions;
 };
 
 } // namespace gk
@@ -65,9 +65,30 @@ class HitboxComponent {
 
 		void resetCurrentHitbox() { m_currentHitboxID = -1; }
 
+		// Two hitboxes collide only if the category of each one is in the mask of the other
+		bool canCollideWith(const HitboxComponent &hitbox) const {
+			return (m_category & hitbox.m_mask) && (hitbox.m_category & m_mask);
+		}
+
+		u32 category() const { return m_category; }
+		void setCategory(u32 category) { m_category = category; }
+
+		u32 mask() const { return m_mask; }
+		void setMask(u32 mask) { m_mask = mask; }
+
+		// Static objects are expected not to move, so they're only tested against
+		// moving objects and aren't checked by MovementController
+		bool isStatic() const { return m_isStatic; }
+		void setStatic(bool isStatic) { m_isStatic = isStatic; }
+
 	private:
 		s8 m_currentHitboxID = -1;
 
+		u32 m_category = 1;
+		u32 m_mask = ~0u;
+
+		bool m_isStatic = false;
+
 		std::vector<FloatRect> m_hitboxes;
 };
 
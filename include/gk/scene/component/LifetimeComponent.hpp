@@ -28,12 +28,38 @@
 #define GK_LIFETIMECOMPONENT_HPP_
 
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
 
+#include "gk/core/GameClock.hpp"
 #include "gk/core/Timer.hpp"
 #include "gk/scene/SceneObject.hpp"
 
 namespace gk {
 
+// Objects whose death state LifetimeController evaluates at its next update,
+// added by their LifetimeComponent from any thread
+class LifetimeCheckList {
+	public:
+		void add(SceneObject *object) {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_objects.emplace_back(object);
+		}
+
+		// Replaces objects with the objects added since the last call
+		void take(std::vector<SceneObject *> &objects) {
+			objects.clear();
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+			objects.swap(m_objects);
+		}
+
+	private:
+		std::mutex m_mutex;
+		std::vector<SceneObject *> m_objects;
+};
+
 class LifetimeComponent {
 	using DeathChecker = std::function<bool(const SceneObject &)>;
 
@@ -42,12 +68,16 @@ class LifetimeComponent {
 		LifetimeComponent(u32 lifetime) : m_lifetime(lifetime) { m_timer.start(); }
 		LifetimeComponent(DeathChecker deathChecker) : m_deathChecker(deathChecker) {}
 
-		void kill() { m_dead = true; }
+		void kill() { m_isKilled = m_isDead = true; m_link.notify(); }
 
 		bool almostDead() { return m_lifetime != 0 && m_timer.time() > m_lifetime / 4 * 3; }
 
+		// Death state evaluated once per tick by LifetimeController, or after kill()
+		bool isDead() const { return m_isDead; }
+
+		// Evaluates the death conditions now, isDead() should be preferred
 		bool dead(const SceneObject &object) const {
-			return m_dead
+			return m_isKilled
 				|| (m_lifetime != 0 && m_timer.time() > m_lifetime)
 				|| (m_deathChecker && m_deathChecker(object));
 		}
@@ -56,18 +86,54 @@ class LifetimeComponent {
 
 		bool areClientsNotified() const { return m_areClientsNotified; }
 
-		void setDeathChecker(DeathChecker deathChecker) { m_deathChecker = deathChecker; }
+		void setDeathChecker(DeathChecker deathChecker) { m_deathChecker = deathChecker; m_link.notify(); }
 		void setClientsNotified(bool areClientsNotified) { m_areClientsNotified = areClientsNotified; }
 
 	private:
+		friend class LifetimeController;
+
+		// Set by LifetimeController when it first sees the component in a scene, so
+		// the object is checked again when it's killed or given a death checker.
+		// Copies aren't linked. A component that is replaced or destroyed has its
+		// object checked again and loses its link, so the new one is scheduled.
+		struct Link {
+			std::shared_ptr<LifetimeCheckList> checkList;
+			SceneObject *object = nullptr;
+
+			u32 checkTick = 0; // Update of LifetimeController the object was last checked in
+
+			Link() = default;
+			Link(const Link &) {}
+			Link(Link &&link) noexcept : checkList(std::move(link.checkList)), object(link.object), checkTick(link.checkTick) {}
+			~Link() { unlink(); }
+
+			Link &operator=(const Link &) { unlink(); return *this; }
+			Link &operator=(Link &&) { unlink(); return *this; }
+
+			void notify() { if (checkList) checkList->add(object); }
+			void unlink() { notify(); checkList.reset(); }
+		};
+
+		// Date of GameClock at which the lifetime is over, cached in m_deathDate by LifetimeController
+		u32 deathDate() const { return GameClock::getInstance().getTicks() - m_timer.time() + m_lifetime + 1; }
+
+		void updateDeathState(const SceneObject &object) {
+			m_isDead = m_isKilled || (m_deathChecker && m_deathChecker(object));
+		}
+
 		Timer m_timer;
 
-		bool m_dead = false;
+		bool m_isKilled = false;
+		bool m_isDead = false;
 		bool m_areClientsNotified = false;
+		bool m_isScheduled = false;
 
 		u32 m_lifetime = 0;
+		u32 m_deathDate = 0;
 
 		DeathChecker m_deathChecker;
+
+		Link m_link;
 };
 
 } // namespace gk
@@ -30,6 +30,7 @@
 #include <memory>
 #include <stack>
 
+#include "gk/core/IntTypes.hpp"
 #include "gk/core/Vector2.hpp"
 #include "gk/scene/movement/Movement.hpp"
 
@@ -72,6 +73,19 @@ class MovementComponent {
 
 		Vector2<bool> isBlocked;
 
+		// If not 0, the object falls asleep after this number of ticks without
+		// velocity: its collisions aren't checked anymore until it moves again
+		// or collides with a moving object
+		u16 sleepDelay = 0;
+		u16 idleTicks = 0;
+
+		bool isSleeping = false;
+
+		void wakeUp() {
+			isSleeping = false;
+			idleTicks = 0;
+		}
+
 		MovementStack movements;
 };
 
@@ -33,8 +33,25 @@ namespace gk {
 
 class PositionComponent : public Vector2f {
 	public:
-		PositionComponent(float x, float y) : Vector2f(x, y) {}
-		PositionComponent(const Vector2f &pos) : Vector2f(pos) {}
+		PositionComponent(float x, float y) : Vector2f(x, y), m_previous(x, y) {}
+		PositionComponent(const Vector2f &pos) : Vector2f(pos), m_previous(pos) {}
+
+		// Keeps the previous position, so the object is still interpolated
+		PositionComponent &operator=(const Vector2f &pos) { Vector2f::operator=(pos); return *this; }
+
+		// Position at the beginning of the last tick, saved by Scene if interpolation is enabled
+		const Vector2f &previous() const { return m_previous; }
+		void savePrevious() { m_previous = *this; }
+
+		Vector2f interpolate(float alpha) const {
+			if (alpha >= 1.f)
+				return *this;
+
+			return {m_previous.x + (x - m_previous.x) * alpha, m_previous.y + (y - m_previous.y) * alpha};
+		}
+
+	private:
+		Vector2f m_previous;
 };
 
 } // namespace gk
@@ -0,0 +1,77 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#ifndef GK_UPDATERATECOMPONENT_HPP_
+#define GK_UPDATERATECOMPONENT_HPP_
+
+#include <algorithm>
+
+#include "gk/core/IntTypes.hpp"
+
+namespace gk {
+
+// Objects with this component are updated by BehaviourController and
+// MovementController every (1 << level) ticks, the level being assigned by
+// UpdateRateController from their distance to the view and points of interest.
+// Objects with a CollisionComponent are due every tick whatever their level.
+class UpdateRateComponent {
+	public:
+		// Highest level, whose interval still fits in 16 bits
+		static constexpr u8 maxLevel = 15;
+
+		u8 level() const { return m_level; }
+		u16 interval() const { return static_cast<u16>(1 << m_level); }
+
+		// Disables the automatic assignment, the level is clamped to maxLevel
+		void setLevel(u8 level) { m_level = std::min(level, maxLevel); m_isAutomatic = false; }
+		void setAutomatic(bool isAutomatic) { m_isAutomatic = isAutomatic; }
+
+		bool isAutomatic() const { return m_isAutomatic; }
+
+		bool isDue() const { return m_isDue; }
+
+		// Number of ticks since the last update, to be used as the time step by
+		// behaviours and movements. MovementController integrates the velocity
+		// over these ticks.
+		u16 elapsedTicks() const { return m_elapsedTicks; }
+
+	private:
+		friend class UpdateRateController;
+
+		u8 m_level = 0;
+		bool m_isAutomatic = true;
+
+		bool m_isScheduled = false;
+		u16 m_phase = 0;
+		u32 m_lastUpdate = 0;
+
+		bool m_isDue = true;
+		u16 m_elapsedTicks = 1;
+};
+
+} // namespace gk
+
+#endif // GK_UPDATERATECOMPONENT_HPP_
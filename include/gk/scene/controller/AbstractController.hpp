@@ -28,6 +28,7 @@
 #define GK_ABSTRACTCONTROLLER_HPP_
 
 #include "gk/scene/SceneObjectList.hpp"
+#include "gk/scene/SceneQuery.hpp"
 
 namespace gk {
 
@@ -38,10 +39,72 @@ class AbstractController {
 		virtual void reset(SceneObject &) {}
 		virtual void update(SceneObject &object) = 0;
 
-		virtual void reset(SceneObjectList &objectList) { for(auto &object : objectList) reset(object); }
-		virtual void update(SceneObjectList &objectList) { for(auto &object : objectList) update(object); }
+		// Called after update(SceneObject &) was called for the objects of a pass,
+		// before other controllers run, to complete the work deferred to process
+		// several objects at once
+		virtual void flush() {}
+
+		// Called once per Scene::update(), after all the controllers were updated
+		virtual void endUpdate() {}
+
+		virtual void reset(SceneObjectList &objectList) {
+			for(auto &object : objectList)
+				if (m_filter.matches(object.signature()))
+					reset(object);
+		}
+
+		virtual void update(SceneObjectList &objectList) {
+			for(auto &object : objectList)
+				if (m_filter.matches(object.signature()))
+					update(object);
+
+			flush();
+		}
 
 		virtual bool isGlobal() const { return false; }
+
+		// If not empty, Scene only passes the objects matching this filter to update(SceneObject &)
+		const ComponentFilter &filter() const { return m_filter; }
+
+		// Components accessed by update(SceneObject &), so Scene can run this controller
+		// alongside the ones that don't write what it reads or read what it writes.
+		// A controller that declares nothing is always run alone.
+		template<typename... Components>
+		AbstractController &reads() { m_readSignature |= componentSignature<Components...>(); m_hasDeclaredAccess = true; return *this; }
+
+		template<typename... Components>
+		AbstractController &writes() { m_writeSignature |= componentSignature<Components...>(); m_hasDeclaredAccess = true; return *this; }
+
+		// If true, update(SceneObject &) may be called for several objects at once
+		// from different threads, so it must only access the object it's given.
+		// Ignored if the controller doesn't declare the components it accesses.
+		AbstractController &setDataParallel(bool isDataParallel) { m_isDataParallel = isDataParallel; return *this; }
+
+		const ComponentSignature &readSignature() const { return m_readSignature; }
+		const ComponentSignature &writeSignature() const { return m_writeSignature; }
+
+		bool hasDeclaredAccess() const { return m_hasDeclaredAccess; }
+		bool isDataParallel() const { return m_isDataParallel; }
+
+		bool conflictsWith(const AbstractController &controller) const {
+			return !m_hasDeclaredAccess || !controller.m_hasDeclaredAccess
+				|| (m_writeSignature & (controller.m_readSignature | controller.m_writeSignature)).any()
+				|| (controller.m_writeSignature & m_readSignature).any();
+		}
+
+	protected:
+		ComponentFilter m_filter;
+
+		ComponentSignature m_readSignature;
+		ComponentSignature m_writeSignature;
+
+		bool m_hasDeclaredAccess = false;
+		bool m_isDataParallel = false;
+
+	private:
+		friend class Scene;
+
+		SceneQuery *m_query = nullptr;
 };
 
 } // namespace gk
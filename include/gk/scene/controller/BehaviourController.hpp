@@ -33,6 +33,8 @@ namespace gk {
 
 class BehaviourController : public AbstractController {
 	public:
+		BehaviourController();
+
 		void update(SceneObject &object) override;
 };
 
@@ -27,16 +27,58 @@
 #ifndef GK_LIFETIMECONTROLLER_HPP_
 #define GK_LIFETIMECONTROLLER_HPP_
 
+#include <memory>
+#include <vector>
+
+#include "gk/core/TimingWheel.hpp"
+#include "gk/scene/component/LifetimeComponent.hpp"
 #include "gk/scene/controller/AbstractController.hpp"
+#include "gk/scene/SceneCommandBuffer.hpp"
 
 namespace gk {
 
+// Evaluates the death state of the objects once per tick, before the other
+// controllers, and destroys the dead objects whose clients are notified.
+// When the list belongs to a Scene, lifetimes are scheduled in a timing wheel
+// instead of reading the timer of each object, and only the objects that are
+// new, were killed, have a death checker or wait to be destroyed are visited
+// each tick.
 class LifetimeController : public AbstractController {
 	public:
+		LifetimeController();
+
 		void update(SceneObjectList &objectList) override;
 		void update(SceneObject &) override {}
 
 		bool isGlobal() const override { return true; }
+
+	private:
+		struct Expiry {
+			SceneObject *object;
+			u32 generation;
+			u32 deathDate;
+		};
+
+		void expireObjects(Scene &scene, u32 time);
+
+		void updateObjects(Scene &scene);
+		void updateObjects(SceneObjectList &objects, SceneCommandBuffer &commands, u32 time);
+
+		TimingWheel<Expiry> m_expiries;
+
+		// Filled by the components killed or given a death checker
+		std::shared_ptr<LifetimeCheckList> m_checkList{new LifetimeCheckList};
+
+		// Objects with a death checker, and dead objects that aren't destroyed yet
+		std::vector<SceneObject *> m_checkedObjects;
+
+		std::vector<SceneObject *> m_objects;
+		std::vector<SceneObject *> m_newObjects;
+		std::vector<SceneObject *> m_deadObjects;
+
+		u32 m_tick = 0;
+
+		Scene *m_scene = nullptr;
 };
 
 } // namespace gk
@@ -27,13 +27,55 @@
 #ifndef GK_MOVEMENTCONTROLLER_HPP_
 #define GK_MOVEMENTCONTROLLER_HPP_
 
+#include <vector>
+
+#include "gk/core/IntTypes.hpp"
 #include "gk/scene/controller/AbstractController.hpp"
 
 namespace gk {
 
+class MovementComponent;
+class PositionComponent;
+
+// Runs the Movement of each object and its collision checks, then applies its
+// velocity. Only the components accessed by the controller itself are declared,
+// so the Movements and the collision actions must only read and write the
+// PositionComponent and MovementComponent of the objects: a game whose actions
+// access other components, e.g. to kill an object, must declare them with
+// reads() and writes(), or the controller may run alongside others using them.
 class MovementController : public AbstractController {
 	public:
+		MovementController();
+
 		void update(SceneObject &object) override;
+		void flush() override;
+
+		// If enabled, objects moved by their velocity only, without an active Movement
+		// or a CollisionComponent, are integrated together with SSE2 or AVX, which
+		// gives the same results as integrating them one by one. The components are
+		// still reached through each object, so it's disabled by default: measure
+		// before enabling it.
+		void setBatchingEnabled(bool isBatchingEnabled) { m_isBatchingEnabled = isBatchingEnabled; }
+
+	private:
+		// Pending objects are integrated by flush(), before the next object that may
+		// read their position and at the end of each pass over the objects.
+		// Sleeping objects are never added.
+		struct Batch {
+			std::vector<MovementComponent *> movements;
+			std::vector<PositionComponent *> positions;
+
+			std::vector<float> x, y, vx, vy, speed;
+			std::vector<u8> isMoving;
+
+			size_t size() const { return movements.size(); }
+
+			void clear();
+		};
+
+		Batch m_batch;
+
+		bool m_isBatchingEnabled = false;
 };
 
 } // namespace gk
@@ -0,0 +1,76 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#ifndef GK_UPDATERATECONTROLLER_HPP_
+#define GK_UPDATERATECONTROLLER_HPP_
+
+#include <vector>
+
+#include "gk/core/Vector2.hpp"
+#include "gk/scene/component/UpdateRateComponent.hpp"
+#include "gk/scene/controller/AbstractController.hpp"
+
+namespace gk {
+
+class View;
+
+// Decides which objects with an UpdateRateComponent are updated this tick, so
+// it must be added before the controllers using it.
+//
+// Objects within the base distance of the view or of a point of interest are
+// updated every tick, then the interval doubles each time the distance does, up
+// to (1 << maxLevel) ticks. Objects of the same level are spread across ticks.
+// The max level is clamped to UpdateRateComponent::maxLevel.
+class UpdateRateController : public AbstractController {
+	public:
+		UpdateRateController(float baseDistance = 512.f, u8 maxLevel = 3);
+
+		void update(SceneObject &object) override;
+		void endUpdate() override { ++m_tick; }
+
+		void setView(const View *view) { m_view = view; }
+
+		void addPointOfInterest(const Vector2f &point) { m_pointsOfInterest.emplace_back(point); }
+		void clearPointsOfInterest() { m_pointsOfInterest.clear(); }
+
+		void setBaseDistance(float baseDistance) { m_baseDistance = baseDistance; }
+		void setMaxLevel(u8 maxLevel) { m_maxLevel = std::min(maxLevel, UpdateRateComponent::maxLevel); }
+
+	private:
+		u8 levelAt(const Vector2f &position) const;
+
+		float m_baseDistance;
+		u8 m_maxLevel;
+
+		const View *m_view = nullptr;
+		std::vector<Vector2f> m_pointsOfInterest;
+
+		u32 m_tick = 0;
+};
+
+} // namespace gk
+
+#endif // GK_UPDATERATECONTROLLER_HPP_
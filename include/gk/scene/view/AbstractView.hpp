@@ -29,6 +29,7 @@
 
 #include "gk/gl/RenderTarget.hpp"
 #include "gk/scene/SceneObjectList.hpp"
+#include "gk/scene/SceneQuery.hpp"
 
 namespace gk {
 
@@ -40,12 +41,60 @@ class AbstractView {
 
 		virtual void draw(const SceneObjectList &objectList, RenderTarget &target, RenderStates states) {
 			for(auto &object : objectList) {
-				draw(object, target, states);
+				if (m_filter.matches(object.signature()))
+					drawIfVisible(object, target, states);
 
-				if (object.has<SceneObjectList>())
-					draw(object.get<SceneObjectList>(), target, states);
+				if (auto *children = object.tryGet<SceneObjectList>())
+					draw(*children, target, states);
 			}
 		}
+
+		// Called by Scene once all the objects were passed to draw(const SceneObject &, ...)
+		virtual void endDraw(RenderTarget &, RenderStates) {}
+
+		// Bounds of the object in world coordinates, used to skip the objects
+		// outside the view of the target. Objects without bounds are always drawn.
+		virtual bool getBounds(const SceneObject &, FloatRect &) const { return false; }
+
+		// If true, the bounds are the hitboxes, so Scene can find the visible objects with its tree
+		virtual bool hasHitboxBounds() const { return false; }
+
+		// Number of objects drawn and skipped during the last Scene::draw()
+		size_t drawnCount() const { return m_drawnCount; }
+		size_t culledCount() const { return m_culledCount; }
+
+		// If not empty, Scene only passes the objects matching this filter to draw(const SceneObject &, ...)
+		const ComponentFilter &filter() const { return m_filter; }
+
+	protected:
+		void drawIfVisible(const SceneObject &object, RenderTarget &target, RenderStates states) {
+			FloatRect bounds;
+			if (m_hasVisibleRect && getBounds(object, bounds) && !bounds.intersects(m_visibleRect)) {
+				++m_culledCount;
+				return;
+			}
+
+			draw(object, target, states);
+			++m_drawnCount;
+		}
+
+		// Fraction of the last tick to interpolate positions with, 1 if interpolation is disabled
+		float interpolationAlpha() const { return m_interpolationAlpha; }
+
+		ComponentFilter m_filter;
+
+	private:
+		friend class Scene;
+
+		SceneQuery *m_query = nullptr;
+
+		bool m_hasVisibleRect = false;
+		FloatRect m_visibleRect;
+
+		size_t m_drawnCount = 0;
+		size_t m_culledCount = 0;
+
+		float m_interpolationAlpha = 1.f;
 };
 
 } // namespace gk
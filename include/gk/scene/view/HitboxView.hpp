@@ -33,7 +33,13 @@ namespace gk {
 
 class HitboxView : public AbstractView {
 	public:
+		HitboxView();
+
 		void draw(const SceneObject &object, RenderTarget &target, RenderStates states);
+
+		bool getBounds(const SceneObject &object, FloatRect &bounds) const override;
+
+		bool hasHitboxBounds() const override { return true; }
 };
 
 } // namespace gk
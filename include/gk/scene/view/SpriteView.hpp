@@ -27,13 +27,30 @@
 #ifndef GK_SPRITEVIEW_HPP_
 #define GK_SPRITEVIEW_HPP_
 
+#include <memory>
+
+#include "gk/graphics/SpriteBatch.hpp"
 #include "gk/scene/view/AbstractView.hpp"
 
 namespace gk {
 
 class SpriteView : public AbstractView {
 	public:
+		SpriteView();
+
 		void draw(const SceneObject &object, RenderTarget &target, RenderStates states) override;
+
+		void endDraw(RenderTarget &target, RenderStates states) override;
+
+		bool getBounds(const SceneObject &object, FloatRect &bounds) const override;
+
+		// Draws the images with a SpriteBatch, which merges the draw calls of
+		// consecutive objects using the same texture. If the order of the objects
+		// doesn't need to be preserved, there's one draw call per texture instead.
+		void setBatchingEnabled(bool isEnabled, bool isOrderPreserved = true);
+
+	private:
+		std::unique_ptr<SpriteBatch> m_batch;
 };
 
 } // namespace gk
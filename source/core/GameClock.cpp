@@ -24,6 +24,7 @@
  *
  * =====================================================================================
  */
+#include <algorithm>
 #include <cmath>
 
 #include "gk/core/SDLHeaders.hpp"
@@ -43,6 +44,11 @@ u32 GameClock::getTicks(bool realTime) {
 	}
 }
 
+float GameClock::getInterpolationAlpha() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return std::min(float(m_lag) / float(m_timestep), 1.f);
+}
+
 void GameClock::updateGame(const std::function<void(void)> &updateFunc) {
 	std::unique_lock<std::mutex> lock(m_mutex);
 
@@ -63,7 +69,7 @@ void GameClock::updateGame(const std::function<void(void)> &updateFunc) {
 void GameClock::drawGame(const std::function<void(void)> &drawFunc) {
 	std::unique_lock<std::mutex> lock(m_mutex);
 
-	if (m_numUpdates > 0) {
+	if (m_numUpdates > 0 || m_frameDuration) {
 		lock.unlock();
 		drawFunc();
 		lock.lock();
@@ -83,8 +89,9 @@ void GameClock::waitForNextFrame() {
 
 	u32 lastFrameDuration = currentTicks - m_timeDropped - m_lastFrameDate;
 
-	if (lastFrameDuration < m_timestep) {
-		SDL_Delay(m_timestep - lastFrameDuration);
+	u32 frameDuration = m_frameDuration ? m_frameDuration : m_timestep;
+	if (lastFrameDuration < frameDuration) {
+		SDL_Delay(frameDuration - lastFrameDuration);
 	}
 
 	lock.unlock();
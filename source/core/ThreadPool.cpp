@@ -0,0 +1,128 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#include "gk/core/ThreadPool.hpp"
+
+namespace gk {
+
+ThreadPool::ThreadPool(u16 workerCount) {
+	m_workers.reserve(workerCount);
+	for (u16 i = 0 ; i < workerCount ; ++i)
+		m_workers.emplace_back(&ThreadPool::workerLoop, this);
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_isStopping = true;
+	}
+
+	m_startCondition.notify_all();
+
+	for (std::thread &worker : m_workers)
+		worker.join();
+}
+
+void ThreadPool::run(size_t taskCount, const std::function<void(size_t)> &task) {
+	if (m_workers.empty() || taskCount < 2) {
+		for (size_t i = 0 ; i < taskCount ; ++i)
+			task(i);
+
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_task = &task;
+		m_taskCount = taskCount;
+		m_nextTask = 0;
+		m_exception = nullptr;
+		++m_batch;
+	}
+
+	m_startCondition.notify_all();
+
+	runTasks();
+
+	std::exception_ptr exception;
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_doneCondition.wait(lock, [this] { return m_activeWorkers == 0; });
+
+		// Workers waking up from now on won't join this batch
+		m_task = nullptr;
+
+		exception = m_exception;
+	}
+
+	if (exception)
+		std::rethrow_exception(exception);
+}
+
+void ThreadPool::workerLoop() {
+	u64 batch = 0;
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_startCondition.wait(lock, [&] { return m_isStopping || m_batch != batch; });
+			if (m_isStopping)
+				return;
+
+			batch = m_batch;
+			if (!m_task)
+				continue;
+
+			++m_activeWorkers;
+		}
+
+		runTasks();
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (--m_activeWorkers == 0)
+				m_doneCondition.notify_all();
+		}
+	}
+}
+
+void ThreadPool::runTasks() {
+	while (true) {
+		size_t i = m_nextTask.fetch_add(1);
+		if (i >= m_taskCount)
+			break;
+
+		try {
+			(*m_task)(i);
+		}
+		catch (...) {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (!m_exception)
+				m_exception = std::current_exception();
+		}
+	}
+}
+
+} // namespace gk
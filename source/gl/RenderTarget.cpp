@@ -24,6 +24,12 @@
  *
  * =====================================================================================
  */
+#include <algorithm>
+#include <cmath>
+
+#include <glm/matrix.hpp>
+
+#include "gk/gl/Camera.hpp"
 #include "gk/gl/GLCheck.hpp"
 #include "gk/gl/Drawable.hpp"
 #include "gk/gl/RenderTarget.hpp"
@@ -99,6 +105,28 @@ void RenderTarget::beginDrawing(const RenderStates &states) {
 		Texture::bind(states.texture);
 }
 
+bool RenderTarget::getVisibleRect(const Transform &transform, FloatRect &rect) const {
+	if (!m_view || dynamic_cast<const Camera *>(m_view))
+		return false;
+
+	glm::mat4 matrix = m_view->getTransform().getMatrix() * m_view->getViewTransform().getMatrix() * transform.getMatrix();
+	glm::mat4 inverse = glm::inverse(matrix);
+
+	float left = INFINITY, top = INFINITY, right = -INFINITY, bottom = -INFINITY;
+	for (float x : {-1.f, 1.f}) {
+		for (float y : {-1.f, 1.f}) {
+			glm::vec4 corner = inverse * glm::vec4{x, y, 0.f, 1.f};
+			left = std::min(left, corner.x / corner.w);
+			top = std::min(top, corner.y / corner.w);
+			right = std::max(right, corner.x / corner.w);
+			bottom = std::max(bottom, corner.y / corner.w);
+		}
+	}
+
+	rect = FloatRect{left, top, right - left, bottom - top};
+	return true;
+}
+
 IntRect RenderTarget::getViewport(const View& view) const {
 	float width  = static_cast<float>(getSize().x);
 	float height = static_cast<float>(getSize().y);
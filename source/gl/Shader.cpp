@@ -113,13 +113,8 @@ void Shader::defaultAttributeLocationBinding() {
 }
 
 void Shader::addShader(GLenum type, const std::string &filename) {
-	GLuint shader;
-	glCheck(shader = glCreateShader(type));
-
 	std::ifstream file(filename);
 	if(!file) {
-		glCheck(glDeleteShader(shader));
-
 		throw EXCEPTION("Failed to open", filename);
 	}
 
@@ -129,6 +124,13 @@ void Shader::addShader(GLenum type, const std::string &filename) {
 	while(getline(file, line)) sourceCode += line + '\n';
 	file.close();
 
+	addShaderFromSource(type, sourceCode, filename);
+}
+
+void Shader::addShaderFromSource(GLenum type, const std::string &sourceCode, const std::string &name) {
+	GLuint shader;
+	glCheck(shader = glCreateShader(type));
+
 	const GLchar *sourceCodeString = sourceCode.c_str();
 
 	glCheck(glShaderSource(shader, 1, &sourceCodeString, nullptr));
@@ -151,7 +153,7 @@ void Shader::addShader(GLenum type, const std::string &filename) {
 		delete[] errorMsg;
 		glCheck(glDeleteShader(shader));
 
-		throw EXCEPTION("Shader", filename, "compilation failed:", error);
+		throw EXCEPTION("Shader", name, "compilation failed:", error);
 	}
 
 	glCheck(glAttachShader(m_program, shader));
@@ -91,12 +91,19 @@ void Image::setPosRect(float x, float y, u16 width, u16 height) {
 }
 
 void Image::updateVertexBuffer() const {
-	Vertex vertices[4] = {
-		{{m_posRect.x + m_posRect.sizeX, m_posRect.y,                   0, -1}},
-		{{m_posRect.x,                   m_posRect.y,                   0, -1}},
-		{{m_posRect.x,                   m_posRect.y + m_posRect.sizeY, 0, -1}},
-		{{m_posRect.x + m_posRect.sizeX, m_posRect.y + m_posRect.sizeY, 0, -1}},
-	};
+	Vertex vertices[4];
+	getVertices(vertices);
+
+	VertexBuffer::bind(&m_vbo);
+	m_vbo.setData(sizeof(vertices), vertices, GL_DYNAMIC_DRAW);
+	VertexBuffer::bind(nullptr);
+}
+
+void Image::getVertices(Vertex vertices[4]) const {
+	vertices[0] = {{m_posRect.x + m_posRect.sizeX, m_posRect.y,                   0, -1}};
+	vertices[1] = {{m_posRect.x,                   m_posRect.y,                   0, -1}};
+	vertices[2] = {{m_posRect.x,                   m_posRect.y + m_posRect.sizeY, 0, -1}};
+	vertices[3] = {{m_posRect.x + m_posRect.sizeX, m_posRect.y + m_posRect.sizeY, 0, -1}};
 
 	FloatRect texRect{
 		m_clipRect.x / float(m_width),
@@ -132,10 +139,6 @@ void Image::updateVertexBuffer() const {
 		vertices[i].color[2] = m_color.b;
 		vertices[i].color[3] = m_color.a;
 	}
-
-	VertexBuffer::bind(&m_vbo);
-	m_vbo.setData(sizeof(vertices), vertices, GL_DYNAMIC_DRAW);
-	VertexBuffer::bind(nullptr);
 }
 
 void Image::draw(RenderTarget &target, RenderStates states) const {
@@ -0,0 +1,131 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#include "gk/gl/GLCheck.hpp"
+#include "gk/gl/RenderTarget.hpp"
+#include "gk/graphics/Image.hpp"
+#include "gk/graphics/SpriteBatch.hpp"
+
+namespace gk {
+
+void SpriteBatch::add(const Image &image, const Transform &transform, const Shader *shader) {
+	Vertex vertices[4];
+	image.getVertices(vertices);
+
+	glm::mat4 matrix = transform.getMatrix() * image.getTransform().getMatrix();
+	for (Vertex &vertex : vertices) {
+		glm::vec4 position = matrix * glm::vec4{vertex.coord3d[0], vertex.coord3d[1], vertex.coord3d[2], 1.f};
+		vertex.coord3d[0] = position.x;
+		vertex.coord3d[1] = position.y;
+		vertex.coord3d[2] = position.z;
+	}
+
+	add(image.m_texture, vertices, shader);
+}
+
+void SpriteBatch::add(const Texture *texture, const Vertex *vertices, const Shader *shader) {
+	u32 group = static_cast<u32>(m_groups.size());
+	if (m_isOrderPreserved) {
+		if (!m_groups.empty() && m_groups.back().texture == texture && m_groups.back().shader == shader)
+			group = static_cast<u32>(m_groups.size() - 1);
+	}
+	else {
+		for (u32 i = 0 ; i < m_groups.size() ; ++i) {
+			if (m_groups[i].texture == texture && m_groups[i].shader == shader) {
+				group = i;
+				break;
+			}
+		}
+	}
+
+	if (group == m_groups.size())
+		m_groups.push_back({texture, shader, 0});
+
+	++m_groups[group].quadCount;
+	m_quadGroups.emplace_back(group);
+
+	m_vertices.insert(m_vertices.end(), vertices, vertices + 4);
+
+	m_isUpdateNeeded = true;
+}
+
+void SpriteBatch::clear() {
+	m_groups.clear();
+	m_vertices.clear();
+	m_quadGroups.clear();
+
+	m_isUpdateNeeded = true;
+}
+
+void SpriteBatch::draw(RenderTarget &target, RenderStates states) const {
+	if (m_quadGroups.empty())
+		return;
+
+	if (!m_vbo) {
+		m_vbo.reset(new VertexBuffer);
+		m_vbo->layout().setupDefaultLayout();
+	}
+
+	if (m_isUpdateNeeded) {
+		// The quads of each group are contiguous in the indices, in the order they were added
+		std::vector<size_t> offsets(m_groups.size());
+		for (size_t i = 1 ; i < m_groups.size() ; ++i)
+			offsets[i] = offsets[i - 1] + m_groups[i - 1].quadCount * 6;
+
+		m_indices.resize(m_quadGroups.size() * 6);
+		for (size_t i = 0 ; i < m_quadGroups.size() ; ++i) {
+			GLuint firstVertex = static_cast<GLuint>(i * 4);
+
+			// Same quad layout as Image::draw()
+			size_t &offset = offsets[m_quadGroups[i]];
+			for (GLuint index : {0u, 1u, 3u, 3u, 1u, 2u})
+				m_indices[offset++] = firstVertex + index;
+		}
+
+		VertexBuffer::bind(m_vbo.get());
+		m_vbo->setData(static_cast<GLsizeiptr>(m_vertices.size() * sizeof(Vertex)), m_vertices.data(), GL_STREAM_DRAW);
+		VertexBuffer::bind(nullptr);
+
+		m_isUpdateNeeded = false;
+	}
+
+	glCheck(glDisable(GL_CULL_FACE));
+	glCheck(glDisable(GL_DEPTH_TEST));
+
+	const Shader *shader = states.shader;
+
+	size_t firstIndex = 0;
+	for (const Group &group : m_groups) {
+		states.texture = group.texture;
+		states.shader = group.shader ? group.shader : shader;
+
+		target.drawElements(*m_vbo, GL_TRIANGLES, static_cast<GLsizei>(group.quadCount * 6), GL_UNSIGNED_INT, &m_indices[firstIndex], states);
+
+		firstIndex += group.quadCount * 6;
+	}
+}
+
+} // namespace gk
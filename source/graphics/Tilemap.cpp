@@ -46,16 +46,45 @@ Tilemap::Tilemap(u16 width, u16 height, Tileset &tileset, const std::vector<std:
 
 void Tilemap::reset() {
 	m_data = m_baseData;
+
+	m_animator.init(*this);
 }
 
 void Tilemap::update() {
-	m_animator.animateTiles(*this);
+	// The texture renderer only needs the animator if the map is too large for it
+	if (m_renderMode == RenderMode::Chunks || m_textureRenderer.isFallbackUsed())
+		m_animator.animateTiles(*this);
+}
+
+void Tilemap::setRenderMode(RenderMode renderMode) {
+	if (m_renderMode == renderMode) return;
+
+	m_renderMode = renderMode;
+
+	// Only the renderer in use keeps a copy of the tiles
+	if (m_renderMode == RenderMode::Chunks) {
+		m_textureRenderer.init(nullptr, 0, 0, 0);
+
+		m_renderer.init(this, m_width, m_height, layerCount());
+	}
+	else {
+		m_renderer.init(nullptr, 0, 0, 0);
+
+		m_textureRenderer.init(this, m_width, m_height, layerCount());
+	}
+
+	m_animator.init(*this);
+
+	updateTiles();
 }
 
 void Tilemap::draw(RenderTarget &target, RenderStates states) const {
 	states.transform *= getTransform();
 
-	target.draw(m_renderer, states);
+	if (m_renderMode == RenderMode::Chunks)
+		target.draw(m_renderer, states);
+	else
+		target.draw(m_textureRenderer, states);
 }
 
 void Tilemap::updateTiles() {
@@ -64,7 +93,7 @@ void Tilemap::updateTiles() {
 			for (u16 tileX = 0 ; tileX < m_width ; tileX++) {
 				u16 tileID = getTile(tileX, tileY, layer);
 
-				m_renderer.updateTile(layer, tileX, tileY, std::max<u16>(0, tileID - m_tilesetOffset), *this);
+				updateRendererTile(layer, tileX, tileY, std::max<u16>(0, tileID - m_tilesetOffset));
 			}
 		}
 	}
@@ -79,13 +108,28 @@ u16 Tilemap::getTile(u16 tileX, u16 tileY, u8 layer) {
 }
 
 void Tilemap::setTile(u16 tileX, u16 tileY, u16 id, bool write, bool persistent) {
-	if(write && tileX + tileY * m_width < m_width * m_height) {
+	bool isWritten = write && tileX + tileY * m_width < m_width * m_height;
+
+	u16 previousID = 0;
+	if(isWritten) {
+		previousID = m_data[layerCount() - 1][tileX + tileY * m_width];
+
 		m_data[layerCount() - 1][tileX + tileY * m_width] = id;
 
 		if (persistent) m_baseData[layerCount() - 1][tileX + tileY * m_width] = id;
 	}
 
-	m_renderer.updateTile(layerCount() - 1, tileX, tileY, std::max<u16>(0, id - m_tilesetOffset), *this);
+	updateRendererTile(u8(layerCount() - 1), tileX, tileY, std::max<u16>(0, id - m_tilesetOffset));
+
+	if (isWritten && previousID != id)
+		m_animator.updateTile(*this, tileX, tileY, previousID);
+}
+
+void Tilemap::updateRendererTile(u8 layer, u16 tileX, u16 tileY, u16 id) {
+	if (m_renderMode == RenderMode::Chunks)
+		m_renderer.updateTile(layer, tileX, tileY, id, *this);
+	else
+		m_textureRenderer.updateTile(layer, tileX, tileY, id, *this);
 }
 
 bool Tilemap::inTile(float x, float y, u16 tileID) {
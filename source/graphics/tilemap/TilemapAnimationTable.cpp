@@ -0,0 +1,76 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#include <algorithm>
+#include <numeric>
+
+#include "gk/graphics/tilemap/TilemapAnimationTable.hpp"
+
+namespace gk {
+
+TilemapAnimationTable::TilemapAnimationTable(u16 tileCount, u16 offset) : m_offset(offset) {
+	m_height = u16(std::max(1, (tileCount + width - 1) / width));
+	m_pixels.assign(size_t(width) * m_height * 4, 0);
+}
+
+void TilemapAnimationTable::addAnimation(u16 tileID, const Tile &tile) {
+	u16 row = m_height++;
+	m_pixels.resize(size_t(width) * m_height * 4, 0);
+
+	// The index rows are as wide as the table, so the texel of an ID is at its index
+	setTexel(&m_pixels[size_t(tileID - m_offset) * 4], row, 0);
+
+	u16 frameCount = std::min<u16>(tile.getFrameCount(), width - 1);
+	u8 *rowPixels = &m_pixels[size_t(row) * width * 4];
+
+	u32 endTime = 0;
+	for (u16 frame = 0 ; frame < frameCount ; ++frame) {
+		endTime = std::min<u32>(endTime + tile.getFrame(frame).duration, 0xffff);
+		setTexel(&rowPixels[(frame + 1) * 4], u16(tile.getFrame(frame).tileID - m_offset), u16(endTime));
+	}
+
+	u16 duration = u16(std::max<u32>(endTime, 1));
+	setTexel(rowPixels, frameCount, duration);
+
+	// An animation that doesn't fit in the period skips to its start when the time wraps
+	u64 period = std::lcm<u64>(m_period, duration);
+	if (period <= maxPeriod)
+		m_period = u32(period);
+}
+
+u32 TilemapAnimationTable::period() const {
+	// The largest multiple, so the time wraps as rarely as possible
+	return m_period * (maxPeriod / m_period);
+}
+
+void TilemapAnimationTable::setTexel(u8 *texel, u16 first, u16 second) {
+	texel[0] = u8(first & 0xff);
+	texel[1] = u8(first >> 8);
+	texel[2] = u8(second & 0xff);
+	texel[3] = u8(second >> 8);
+}
+
+} // namespace gk
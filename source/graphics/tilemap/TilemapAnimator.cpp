@@ -30,31 +30,79 @@
 namespace gk {
 
 void TilemapAnimator::init(Tilemap &map) {
-	m_tileAnimations.assign(map.width() * map.height(), {});
+	m_groups.clear();
+	m_groupIndices.clear();
+	m_cellPositions.clear();
+
+	for (u16 y = 0 ; y < map.height() ; ++y)
+		for (u16 x = 0 ; x < map.width() ; ++x)
+			addCell(map, x + y * map.width(), map.getTile(x, y));
 }
 
 void TilemapAnimator::animateTiles(Tilemap &map) {
-	for (u16 x = 0 ; x < map.width() ; ++x) {
-		for (u16 y = 0 ; y < map.height() ; ++y) {
-			const Tile &tile = map.tileset().getTile(map.getTile(x, y));
-			if (tile.getFrameCount()) {
-				TileAnimation &tileAnimation = m_tileAnimations.at(x + y * map.width());
-				if (!tileAnimation.timer.isStarted())
-					tileAnimation.timer.start();
-
-				if (tileAnimation.timer.time() > tile.getFrame(tileAnimation.currentFrame).duration) {
-					tileAnimation.currentFrame++;
-					tileAnimation.currentFrame %= tile.getFrameCount();
-
-					map.setTile(x, y, tile.getFrame(tileAnimation.currentFrame).tileID, false);
-
-					tileAnimation.timer.reset();
-					tileAnimation.timer.start();
-				}
-			}
+	for (AnimationGroup &group : m_groups) {
+		if (group.cells.empty())
+			continue;
+
+		if (!group.timer.isStarted())
+			group.timer.start();
+
+		const Tile &tile = map.tileset().getTile(group.tileID);
+		if (group.timer.time() > tile.getFrame(group.currentFrame).duration) {
+			group.currentFrame++;
+			group.currentFrame %= tile.getFrameCount();
+
+			u16 tileID = tile.getFrame(group.currentFrame).tileID;
+			for (u32 cell : group.cells)
+				map.setTile(u16(cell % map.width()), u16(cell / map.width()), tileID, false);
+
+			group.timer.reset();
+			group.timer.start();
 		}
 	}
 }
 
-} // namespace gk
+void TilemapAnimator::updateTile(Tilemap &map, u16 tileX, u16 tileY, u16 previousID) {
+	u32 cell = tileX + tileY * map.width();
+
+	removeCell(cell, previousID);
+	addCell(map, cell, map.getTile(tileX, tileY));
+}
+
+void TilemapAnimator::addCell(Tilemap &map, u32 cell, u16 tileID) {
+	const Tile &tile = map.tileset().getTile(tileID);
+	if (!tile.getFrameCount())
+		return;
+
+	auto it = m_groupIndices.find(tileID);
+	if (it == m_groupIndices.end()) {
+		it = m_groupIndices.emplace(tileID, u32(m_groups.size())).first;
+		m_groups.emplace_back().tileID = tileID;
+	}
+
+	AnimationGroup &group = m_groups[it->second];
+	m_cellPositions[cell] = u32(group.cells.size());
+	group.cells.emplace_back(cell);
+
+	// The cell joins the group at its current frame
+	if (group.currentFrame != 0)
+		map.setTile(u16(cell % map.width()), u16(cell / map.width()), tile.getFrame(group.currentFrame).tileID, false);
+}
+
+void TilemapAnimator::removeCell(u32 cell, u16 tileID) {
+	auto it = m_groupIndices.find(tileID);
+	auto positionIt = m_cellPositions.find(cell);
+	if (it == m_groupIndices.end() || positionIt == m_cellPositions.end())
+		return;
 
+	std::vector<u32> &cells = m_groups[it->second].cells;
+
+	u32 position = positionIt->second;
+	cells[position] = cells.back();
+	m_cellPositions[cells[position]] = position;
+	cells.pop_back();
+
+	m_cellPositions.erase(positionIt);
+}
+
+} // namespace gk
@@ -24,6 +24,9 @@
  *
  * =====================================================================================
  */
+#include <algorithm>
+#include <cmath>
+
 #include "gk/gl/GLCheck.hpp"
 #include "gk/gl/Shader.hpp"
 #include "gk/gl/Vertex.hpp"
@@ -32,63 +35,166 @@
 
 namespace gk {
 
-TilemapRenderer::TilemapRenderer() {
-	m_vbo.layout().setupDefaultLayout();
-}
-
 void TilemapRenderer::init(Tilemap *map, u16 mapWidth, u16 mapHeight, u8 mapLayers) {
 	m_map = map;
 
-	VertexBuffer::bind(&m_vbo);
-	m_vbo.setData(sizeof(Vertex) * mapWidth * mapHeight * mapLayers * 6, nullptr, GL_DYNAMIC_DRAW);
-	VertexBuffer::bind(nullptr);
+	m_width = mapWidth;
+	m_height = mapHeight;
+	m_layerCount = mapLayers;
+
+	m_chunkCountX = u16((mapWidth + chunkSize - 1) / chunkSize);
+	m_chunkCountY = u16((mapHeight + chunkSize - 1) / chunkSize);
+
+	m_tiles.assign(size_t(mapWidth) * mapHeight * mapLayers, 0);
+
+	m_chunks.clear();
+	m_chunks.resize(size_t(m_chunkCountX) * m_chunkCountY * mapLayers);
 }
 
-void TilemapRenderer::updateTile(u8 layer, u16 tileX, u16 tileY, u16 id, Tilemap &map) {
-	if (id == 0) return;
+void TilemapRenderer::updateTile(u8 layer, u16 tileX, u16 tileY, u16 id, Tilemap &) {
+	if (layer >= m_layerCount || tileX >= m_width || tileY >= m_height) return;
 
-	VertexBuffer::bind(&m_vbo);
+	u16 &tile = m_tiles[tileX + tileY * m_width + layer * m_width * m_height];
+	if (tile == id) return;
 
-	u16 tileWidth  = map.tileset().tileWidth();
-	u16 tileHeight = map.tileset().tileHeight();
+	bool isStructureChanged = (tile == 0 || id == 0);
+	tile = id;
 
-	float x = float(tileX * tileWidth);
-	float y = float(tileY * tileHeight);
+	Chunk &chunk = getChunk(layer, u16(tileX / chunkSize), u16(tileY / chunkSize));
+	if (chunk.isRebuildNeeded) return;
 
-	float texTileX = id % u16(map.tileset().getSize().x / tileWidth) * tileWidth  / (float)map.tileset().getSize().x;
-	float texTileY = id / u16(map.tileset().getSize().x / tileWidth) * tileHeight / (float)map.tileset().getSize().y;
+	// The slots of the tiles only change if a tile is added or removed
+	if (isStructureChanged || chunk.slots.empty()) {
+		chunk.isRebuildNeeded = true;
+		return;
+	}
 
-	float texTileWidth  = tileWidth  / (float)map.tileset().getSize().x;
-	float texTileHeight = tileHeight / (float)map.tileset().getSize().y;
+	u16 slot = chunk.slots[tileX % chunkSize + tileY % chunkSize * chunkSize];
+	getTileVertices(tileX, tileY, id, &chunk.vertices[slot * 6u]);
+	chunk.dirtySlots.emplace_back(slot);
 
-	Vertex vertices[] = {
-		{{x            , y             , 0, 1}, {texTileX               , texTileY                }, {1.0f, 1.0f, 1.0f, 1.0f}},
-		{{x + tileWidth, y             , 0, 1}, {texTileX + texTileWidth, texTileY                }, {1.0f, 1.0f, 1.0f, 1.0f}},
-		{{x + tileWidth, y + tileHeight, 0, 1}, {texTileX + texTileWidth, texTileY + texTileHeight}, {1.0f, 1.0f, 1.0f, 1.0f}},
-		{{x            , y             , 0, 1}, {texTileX               , texTileY                }, {1.0f, 1.0f, 1.0f, 1.0f}},
-		{{x + tileWidth, y + tileHeight, 0, 1}, {texTileX + texTileWidth, texTileY + texTileHeight}, {1.0f, 1.0f, 1.0f, 1.0f}},
-		{{x            , y + tileHeight, 0, 1}, {texTileX               , texTileY + texTileHeight}, {1.0f, 1.0f, 1.0f, 1.0f}}
-	};
+	// Animated tiles of a chunk out of view would keep adding the same slots
+	if (chunk.dirtySlots.size() > chunk.vertices.size() / 6) {
+		std::sort(chunk.dirtySlots.begin(), chunk.dirtySlots.end());
+		chunk.dirtySlots.erase(std::unique(chunk.dirtySlots.begin(), chunk.dirtySlots.end()), chunk.dirtySlots.end());
+	}
+}
+
+TilemapRenderer::Chunk &TilemapRenderer::getChunk(u8 layer, u16 chunkX, u16 chunkY) const {
+	return m_chunks[chunkX + chunkY * m_chunkCountX + layer * m_chunkCountX * m_chunkCountY];
+}
+
+void TilemapRenderer::rebuildChunk(Chunk &chunk, u8 layer, u16 chunkX, u16 chunkY) const {
+	chunk.vertices.clear();
+	chunk.slots.assign(chunkSize * chunkSize, noSlot);
+	chunk.dirtySlots.clear();
+	chunk.isRebuildNeeded = false;
+
+	u16 endX = std::min<u16>(u16((chunkX + 1) * chunkSize), m_width);
+	u16 endY = std::min<u16>(u16((chunkY + 1) * chunkSize), m_height);
+	for (u16 tileY = u16(chunkY * chunkSize) ; tileY < endY ; ++tileY) {
+		for (u16 tileX = u16(chunkX * chunkSize) ; tileX < endX ; ++tileX) {
+			u16 id = m_tiles[tileX + tileY * m_width + layer * m_width * m_height];
+			if (id == 0) continue;
 
-	m_vbo.updateData(sizeof(vertices) * (tileX + tileY * map.width() + layer * map.width() * map.height()), sizeof(vertices), vertices);
+			chunk.slots[tileX % chunkSize + tileY % chunkSize * chunkSize] = u16(chunk.vertices.size() / 6);
+
+			chunk.vertices.resize(chunk.vertices.size() + 6);
+			getTileVertices(tileX, tileY, id, &chunk.vertices[chunk.vertices.size() - 6]);
+		}
+	}
+
+	if (chunk.vertices.empty()) return;
+
+	if (!chunk.vbo) {
+		chunk.vbo.reset(new VertexBuffer);
+		chunk.vbo->layout().setupDefaultLayout();
+	}
 
+	VertexBuffer::bind(chunk.vbo.get());
+	chunk.vbo->setData(GLsizeiptr(sizeof(Vertex) * chunk.vertices.size()), chunk.vertices.data(), GL_DYNAMIC_DRAW);
 	VertexBuffer::bind(nullptr);
 }
 
+void TilemapRenderer::uploadDirtySlots(Chunk &chunk) const {
+	std::sort(chunk.dirtySlots.begin(), chunk.dirtySlots.end());
+
+	VertexBuffer::bind(chunk.vbo.get());
+
+	// Consecutive slots are merged into one range
+	for (size_t i = 0 ; i < chunk.dirtySlots.size() ; ) {
+		u16 first = chunk.dirtySlots[i];
+		u16 last = first;
+		while (++i < chunk.dirtySlots.size() && chunk.dirtySlots[i] <= last + 1)
+			last = chunk.dirtySlots[i];
+
+		chunk.vbo->updateData(GLintptr(sizeof(Vertex) * 6 * first), GLsizeiptr(sizeof(Vertex) * 6 * (last - first + 1)), &chunk.vertices[first * 6u]);
+	}
+
+	VertexBuffer::bind(nullptr);
+
+	chunk.dirtySlots.clear();
+}
+
+void TilemapRenderer::getTileVertices(u16 tileX, u16 tileY, u16 id, Vertex vertices[6]) const {
+	Tileset &tileset = m_map->tileset();
+
+	u16 tileWidth  = tileset.tileWidth();
+	u16 tileHeight = tileset.tileHeight();
+
+	float x = float(tileX * tileWidth);
+	float y = float(tileY * tileHeight);
+
+	float texTileX = id % u16(tileset.getSize().x / tileWidth) * tileWidth  / (float)tileset.getSize().x;
+	float texTileY = id / u16(tileset.getSize().x / tileWidth) * tileHeight / (float)tileset.getSize().y;
+
+	float texTileWidth  = tileWidth  / (float)tileset.getSize().x;
+	float texTileHeight = tileHeight / (float)tileset.getSize().y;
+
+	vertices[0] = {{x            , y             , 0, 1}, {texTileX               , texTileY                }, {1.0f, 1.0f, 1.0f, 1.0f}};
+	vertices[1] = {{x + tileWidth, y             , 0, 1}, {texTileX + texTileWidth, texTileY                }, {1.0f, 1.0f, 1.0f, 1.0f}};
+	vertices[2] = {{x + tileWidth, y + tileHeight, 0, 1}, {texTileX + texTileWidth, texTileY + texTileHeight}, {1.0f, 1.0f, 1.0f, 1.0f}};
+	vertices[3] = {{x            , y             , 0, 1}, {texTileX               , texTileY                }, {1.0f, 1.0f, 1.0f, 1.0f}};
+	vertices[4] = {{x + tileWidth, y + tileHeight, 0, 1}, {texTileX + texTileWidth, texTileY + texTileHeight}, {1.0f, 1.0f, 1.0f, 1.0f}};
+	vertices[5] = {{x            , y + tileHeight, 0, 1}, {texTileX               , texTileY + texTileHeight}, {1.0f, 1.0f, 1.0f, 1.0f}};
+}
+
 void TilemapRenderer::draw(RenderTarget &target, RenderStates states) const {
-	if (!m_map) return;
+	if (!m_map || m_chunks.empty()) return;
+
+	u16 chunkWidth  = u16(m_map->tileset().tileWidth() * chunkSize);
+	u16 chunkHeight = u16(m_map->tileset().tileHeight() * chunkSize);
+
+	// Range of chunks intersecting the view, in map coordinates
+	s32 firstX = 0, firstY = 0, lastX = m_chunkCountX - 1, lastY = m_chunkCountY - 1;
+	FloatRect visibleRect;
+	if (target.getVisibleRect(states.transform, visibleRect)) {
+		firstX = std::max(firstX, s32(std::floor(visibleRect.x / chunkWidth)));
+		firstY = std::max(firstY, s32(std::floor(visibleRect.y / chunkHeight)));
+		lastX = std::min(lastX, s32(std::floor((visibleRect.x + visibleRect.sizeX) / chunkWidth)));
+		lastY = std::min(lastY, s32(std::floor((visibleRect.y + visibleRect.sizeY) / chunkHeight)));
+	}
 
 	states.texture = &m_map->tileset();
 
 	glCheck(glDisable(GL_CULL_FACE));
 	glCheck(glDisable(GL_DEPTH_TEST));
 
-	for (u8 i = 0 ; i < m_map->layerCount() ; ++i) {
-		target.draw(m_vbo, GL_TRIANGLES,
-			(6 * m_map->width() * m_map->height()) * (m_map->layerCount() - 1 - i),
-			6 * m_map->width() * m_map->height(), states);
+	for (u8 i = 0 ; i < m_layerCount ; ++i) {
+		u8 layer = u8(m_layerCount - 1 - i);
+		for (s32 chunkY = firstY ; chunkY <= lastY ; ++chunkY) {
+			for (s32 chunkX = firstX ; chunkX <= lastX ; ++chunkX) {
+				Chunk &chunk = getChunk(layer, u16(chunkX), u16(chunkY));
+				if (chunk.isRebuildNeeded)
+					rebuildChunk(chunk, layer, u16(chunkX), u16(chunkY));
+				else if (!chunk.dirtySlots.empty())
+					uploadDirtySlots(chunk);
+
+				if (!chunk.vertices.empty())
+					target.draw(*chunk.vbo, GL_TRIANGLES, 0, GLsizei(chunk.vertices.size()), states);
+			}
+		}
 	}
 }
 
 } // namespace gk
-
@@ -0,0 +1,395 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#include <algorithm>
+
+#include "gk/core/Debug.hpp"
+#include "gk/gl/GLCheck.hpp"
+#include "gk/gl/Vertex.hpp"
+#include "gk/graphics/tilemap/TilemapAnimationTable.hpp"
+#include "gk/graphics/tilemap/TilemapTextureRenderer.hpp"
+#include "gk/graphics/Tilemap.hpp"
+
+namespace gk {
+
+static const char *vertexShaderSource = R"(
+#version 120
+
+attribute vec4 coord3d;
+attribute vec2 texCoord;
+
+varying vec2 v_cell;
+
+uniform mat4 u_modelMatrix;
+uniform mat4 u_projectionMatrix;
+uniform mat4 u_viewMatrix;
+
+void main() {
+	v_cell = texCoord;
+
+	gl_Position = u_projectionMatrix * u_viewMatrix * u_modelMatrix * coord3d;
+}
+)";
+
+static const char *fragmentShaderSource = R"(
+#version 120
+
+varying vec2 v_cell;
+
+uniform sampler2D u_tileset;
+uniform sampler2D u_tileIDs;
+uniform sampler2D u_animationTable;
+
+uniform vec2 u_mapSize;
+uniform vec2 u_tileSize;
+uniform vec2 u_tilesetSize;
+uniform float u_tilesetColumns;
+uniform float u_animationTableHeight;
+uniform float u_time;
+
+float decode(vec2 value) {
+	return floor(value.x * 255.0 + 0.5) + floor(value.y * 255.0 + 0.5) * 256.0;
+}
+
+vec4 tableTexel(float x, float y) {
+	return texture2D(u_animationTable, vec2((x + 0.5) / 256.0, (y + 0.5) / u_animationTableHeight));
+}
+
+void main() {
+	vec2 cell = floor(v_cell);
+	float id = decode(texture2D(u_tileIDs, (cell + 0.5) / u_mapSize).rg);
+
+	float row = decode(tableTexel(mod(id, 256.0), floor(id / 256.0)).rg);
+	if (row != 0.0) {
+		vec4 header = tableTexel(0.0, row);
+		float frameCount = decode(header.rg);
+		float time = mod(u_time, decode(header.ba));
+
+		for (int i = 1 ; i < 256 ; ++i) {
+			vec4 frame = tableTexel(float(i), row);
+			if (time < decode(frame.ba) || float(i) >= frameCount) {
+				id = decode(frame.rg);
+				break;
+			}
+		}
+	}
+
+	if (id == 0.0) discard;
+
+	float tileY = floor((id + 0.5) / u_tilesetColumns);
+	vec2 tile = vec2(id - tileY * u_tilesetColumns, tileY);
+
+	gl_FragColor = texture2D(u_tileset, (tile + fract(v_cell)) * u_tileSize / u_tilesetSize);
+}
+)";
+
+static GLuint createTexture(GLsizei width, GLsizei height, const u8 *pixels) {
+	GLuint texture;
+	glCheck(glGenTextures(1, &texture));
+	glCheck(glBindTexture(GL_TEXTURE_2D, texture));
+
+	glCheck(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels));
+
+	glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+	glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+	glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+	glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+
+	return texture;
+}
+
+TilemapTextureRenderer::TilemapTextureRenderer(TilemapTextureRenderer &&renderer) {
+	*this = std::move(renderer);
+}
+
+TilemapTextureRenderer::~TilemapTextureRenderer() {
+	deleteTextures();
+}
+
+TilemapTextureRenderer &TilemapTextureRenderer::operator=(TilemapTextureRenderer &&renderer) {
+	if (&renderer == this) return *this;
+
+	deleteTextures();
+
+	m_map = renderer.m_map;
+
+	m_width = renderer.m_width;
+	m_height = renderer.m_height;
+	m_layerCount = renderer.m_layerCount;
+
+	m_tiles = std::move(renderer.m_tiles);
+	m_dirtyTiles = std::move(renderer.m_dirtyTiles);
+
+	// The source keeps no texture name, so that they're only deleted once
+	m_layerTextures = std::move(renderer.m_layerTextures);
+	renderer.m_layerTextures.clear();
+
+	m_animationTable = renderer.m_animationTable;
+	m_animationTableHeight = renderer.m_animationTableHeight;
+	m_animationPeriod = renderer.m_animationPeriod;
+	renderer.m_animationTable = 0;
+
+	m_shader = std::move(renderer.m_shader);
+	m_vbo = std::move(renderer.m_vbo);
+
+	m_timer = renderer.m_timer;
+
+	m_fallbackRenderer = std::move(renderer.m_fallbackRenderer);
+	m_isFallbackUsed = renderer.m_isFallbackUsed;
+	renderer.m_isFallbackUsed = false;
+
+	return *this;
+}
+
+void TilemapTextureRenderer::init(Tilemap *map, u16 mapWidth, u16 mapHeight, u8 mapLayers) {
+	m_map = map;
+
+	m_width = mapWidth;
+	m_height = mapHeight;
+	m_layerCount = mapLayers;
+
+	m_tiles.assign(size_t(mapWidth) * mapHeight * mapLayers, 0);
+	m_dirtyTiles.clear();
+
+	// The textures are created again with the new size and tileset on next draw
+	deleteTextures();
+
+	m_vbo.reset();
+
+	m_fallbackRenderer.init(nullptr, 0, 0, 0);
+	m_isFallbackUsed = false;
+}
+
+void TilemapTextureRenderer::updateTile(u8 layer, u16 tileX, u16 tileY, u16 id, Tilemap &map) {
+	if (layer >= m_layerCount || tileX >= m_width || tileY >= m_height) return;
+
+	u32 index = tileX + tileY * m_width + layer * m_width * m_height;
+	if (m_tiles[index] == id) return;
+
+	m_tiles[index] = id;
+
+	if (m_isFallbackUsed)
+		m_fallbackRenderer.updateTile(layer, tileX, tileY, id, map);
+	else if (!m_layerTextures.empty())
+		m_dirtyTiles.emplace_back(index);
+}
+
+void TilemapTextureRenderer::createLayerTextures() const {
+	std::vector<u8> pixels(size_t(m_width) * m_height * 4);
+
+	glCheck(glActiveTexture(GL_TEXTURE1));
+
+	for (u8 layer = 0 ; layer < m_layerCount ; ++layer) {
+		const u16 *tiles = &m_tiles[size_t(layer) * m_width * m_height];
+		for (size_t i = 0 ; i < size_t(m_width) * m_height ; ++i)
+			TilemapAnimationTable::setTexel(&pixels[i * 4], tiles[i], 0);
+
+		m_layerTextures.emplace_back(createTexture(m_width, m_height, pixels.data()));
+	}
+
+	glCheck(glBindTexture(GL_TEXTURE_2D, 0));
+	glCheck(glActiveTexture(GL_TEXTURE0));
+
+	m_dirtyTiles.clear();
+}
+
+void TilemapTextureRenderer::createAnimationTable() const {
+	const Tileset &tileset = m_map->tileset();
+	u16 offset = m_map->tilesetOffset();
+
+	TilemapAnimationTable table{tileset.tileCount(), offset};
+	for (u16 tileID = offset ; tileID < tileset.tileCount() ; ++tileID)
+		if (tileset.getTile(tileID).getFrameCount())
+			table.addAnimation(tileID, tileset.getTile(tileID));
+
+	m_animationTableHeight = table.height();
+	m_animationPeriod = table.period();
+
+	glCheck(glActiveTexture(GL_TEXTURE2));
+	m_animationTable = createTexture(TilemapAnimationTable::width, m_animationTableHeight, table.pixels().data());
+	glCheck(glBindTexture(GL_TEXTURE_2D, 0));
+	glCheck(glActiveTexture(GL_TEXTURE0));
+}
+
+void TilemapTextureRenderer::deleteTextures() const {
+	if (!m_layerTextures.empty()) {
+		glCheck(glDeleteTextures(GLsizei(m_layerTextures.size()), m_layerTextures.data()));
+		m_layerTextures.clear();
+	}
+
+	if (m_animationTable) {
+		glCheck(glDeleteTextures(1, &m_animationTable));
+		m_animationTable = 0;
+	}
+
+	m_animationTableHeight = 0;
+	m_animationPeriod = 0;
+	m_dirtyTiles.clear();
+}
+
+bool TilemapTextureRenderer::isTextureSizeSupported() const {
+	GLint maxSize = 0;
+	glCheck(glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize));
+
+	return m_width <= maxSize && m_height <= maxSize;
+}
+
+void TilemapTextureRenderer::enableFallback() const {
+	gkWarning() << "Tilemap of" << m_width << "x" << m_height << "tiles is larger than the maximum texture size, using chunks instead";
+
+	m_isFallbackUsed = true;
+
+	m_fallbackRenderer.init(m_map, m_width, m_height, m_layerCount);
+
+	for (u8 layer = 0 ; layer < m_layerCount ; ++layer)
+		for (u16 tileY = 0 ; tileY < m_height ; ++tileY)
+			for (u16 tileX = 0 ; tileX < m_width ; ++tileX)
+				m_fallbackRenderer.updateTile(layer, tileX, tileY, m_tiles[tileX + tileY * m_width + size_t(layer) * m_width * m_height], *m_map);
+}
+
+void TilemapTextureRenderer::createShader() const {
+	m_shader.reset(new Shader);
+	m_shader->createProgram();
+	m_shader->addShaderFromSource(GL_VERTEX_SHADER, vertexShaderSource, "TilemapTextureRenderer");
+	m_shader->addShaderFromSource(GL_FRAGMENT_SHADER, fragmentShaderSource, "TilemapTextureRenderer");
+	m_shader->linkProgram();
+}
+
+void TilemapTextureRenderer::uploadDirtyTiles() const {
+	std::sort(m_dirtyTiles.begin(), m_dirtyTiles.end());
+	m_dirtyTiles.erase(std::unique(m_dirtyTiles.begin(), m_dirtyTiles.end()), m_dirtyTiles.end());
+
+	glCheck(glActiveTexture(GL_TEXTURE1));
+
+	u8 layer = 0xff;
+	for (u32 index : m_dirtyTiles) {
+		u32 layerSize = u32(m_width) * m_height;
+		if (index / layerSize != layer) {
+			layer = u8(index / layerSize);
+			glCheck(glBindTexture(GL_TEXTURE_2D, m_layerTextures[layer]));
+		}
+
+		u8 texel[4];
+		TilemapAnimationTable::setTexel(texel, m_tiles[index], 0);
+
+		u32 tile = index % layerSize;
+		glCheck(glTexSubImage2D(GL_TEXTURE_2D, 0, GLint(tile % m_width), GLint(tile / m_width), 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, texel));
+	}
+
+	glCheck(glBindTexture(GL_TEXTURE_2D, 0));
+	glCheck(glActiveTexture(GL_TEXTURE0));
+
+	m_dirtyTiles.clear();
+}
+
+void TilemapTextureRenderer::draw(RenderTarget &target, RenderStates states) const {
+	if (!m_map || m_tiles.empty()) return;
+
+	if (m_layerTextures.empty() && !m_isFallbackUsed && !isTextureSizeSupported())
+		enableFallback();
+
+	if (m_isFallbackUsed) {
+		target.draw(m_fallbackRenderer, states);
+		return;
+	}
+
+	const Tileset &tileset = m_map->tileset();
+
+	if (!m_shader)
+		createShader();
+
+	if (!m_animationTable)
+		createAnimationTable();
+
+	if (m_layerTextures.empty())
+		createLayerTextures();
+	else if (!m_dirtyTiles.empty())
+		uploadDirtyTiles();
+
+	if (!m_vbo) {
+		float width  = float(m_width * tileset.tileWidth());
+		float height = float(m_height * tileset.tileHeight());
+		float mapWidth  = float(m_width);
+		float mapHeight = float(m_height);
+
+		Vertex vertices[6] = {
+			{{0    , 0     , 0, 1}, {0       , 0        }, {1.0f, 1.0f, 1.0f, 1.0f}},
+			{{width, 0     , 0, 1}, {mapWidth, 0        }, {1.0f, 1.0f, 1.0f, 1.0f}},
+			{{width, height, 0, 1}, {mapWidth, mapHeight}, {1.0f, 1.0f, 1.0f, 1.0f}},
+			{{0    , 0     , 0, 1}, {0       , 0        }, {1.0f, 1.0f, 1.0f, 1.0f}},
+			{{width, height, 0, 1}, {mapWidth, mapHeight}, {1.0f, 1.0f, 1.0f, 1.0f}},
+			{{0    , height, 0, 1}, {0       , mapHeight}, {1.0f, 1.0f, 1.0f, 1.0f}},
+		};
+
+		m_vbo.reset(new VertexBuffer);
+		m_vbo->layout().setupDefaultLayout();
+
+		VertexBuffer::bind(m_vbo.get());
+		m_vbo->setData(sizeof(vertices), vertices, GL_STATIC_DRAW);
+		VertexBuffer::bind(nullptr);
+	}
+
+	if (!m_timer.isStarted())
+		m_timer.start();
+
+	Shader::bind(m_shader.get());
+	m_shader->setUniform("u_tileset", 0);
+	m_shader->setUniform("u_tileIDs", 1);
+	m_shader->setUniform("u_animationTable", 2);
+	m_shader->setUniform(m_shader->uniform("u_mapSize"), float(m_width), float(m_height));
+	m_shader->setUniform(m_shader->uniform("u_tileSize"), float(tileset.tileWidth()), float(tileset.tileHeight()));
+	m_shader->setUniform(m_shader->uniform("u_tilesetSize"), float(tileset.getSize().x), float(tileset.getSize().y));
+	m_shader->setUniform("u_tilesetColumns", float(tileset.getSize().x / tileset.tileWidth()));
+	m_shader->setUniform("u_animationTableHeight", float(m_animationTableHeight));
+	m_shader->setUniform("u_time", float(m_timer.time() % m_animationPeriod));
+
+	states.shader = m_shader.get();
+	states.texture = &tileset;
+
+	glCheck(glDisable(GL_CULL_FACE));
+	glCheck(glDisable(GL_DEPTH_TEST));
+
+	glCheck(glActiveTexture(GL_TEXTURE2));
+	glCheck(glBindTexture(GL_TEXTURE_2D, m_animationTable));
+
+	for (u8 i = 0 ; i < m_layerCount ; ++i) {
+		u8 layer = u8(m_layerCount - 1 - i);
+
+		glCheck(glActiveTexture(GL_TEXTURE1));
+		glCheck(glBindTexture(GL_TEXTURE_2D, m_layerTextures[layer]));
+		glCheck(glActiveTexture(GL_TEXTURE0));
+
+		target.draw(*m_vbo, GL_TRIANGLES, 0, 6, states);
+	}
+
+	glCheck(glActiveTexture(GL_TEXTURE1));
+	glCheck(glBindTexture(GL_TEXTURE_2D, 0));
+	glCheck(glActiveTexture(GL_TEXTURE2));
+	glCheck(glBindTexture(GL_TEXTURE_2D, 0));
+	glCheck(glActiveTexture(GL_TEXTURE0));
+}
+
+} // namespace gk
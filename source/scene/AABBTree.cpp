@@ -0,0 +1,305 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#include "gk/scene/AABBTree.hpp"
+
+namespace gk {
+
+static FloatRect merge(const FloatRect &rect1, const FloatRect &rect2) {
+	float x = std::min(rect1.x, rect2.x);
+	float y = std::min(rect1.y, rect2.y);
+
+	return FloatRect{x, y,
+		std::max(rect1.x + rect1.sizeX, rect2.x + rect2.sizeX) - x,
+		std::max(rect1.y + rect1.sizeY, rect2.y + rect2.sizeY) - y};
+}
+
+static float perimeter(const FloatRect &rect) {
+	return 2.f * (rect.sizeX + rect.sizeY);
+}
+
+static bool contains(const FloatRect &rect1, const FloatRect &rect2) {
+	return rect1.x <= rect2.x && rect1.y <= rect2.y
+	    && rect1.x + rect1.sizeX >= rect2.x + rect2.sizeX
+	    && rect1.y + rect1.sizeY >= rect2.y + rect2.sizeY;
+}
+
+s32 AABBTree::insert(const FloatRect &rect, SceneObject *object) {
+	s32 leaf = allocateNode();
+
+	Node &node = m_nodes[leaf];
+	node.rect = FloatRect{rect.x - m_margin, rect.y - m_margin, rect.sizeX + m_margin * 2.f, rect.sizeY + m_margin * 2.f};
+	node.object = object;
+	node.height = 0;
+
+	insertLeaf(leaf);
+
+	++m_leafCount;
+
+	return leaf;
+}
+
+void AABBTree::remove(s32 leaf) {
+	removeLeaf(leaf);
+	freeNode(leaf);
+
+	--m_leafCount;
+}
+
+bool AABBTree::move(s32 leaf, const FloatRect &rect) {
+	if (contains(m_nodes[leaf].rect, rect))
+		return false;
+
+	removeLeaf(leaf);
+
+	m_nodes[leaf].rect = FloatRect{rect.x - m_margin, rect.y - m_margin, rect.sizeX + m_margin * 2.f, rect.sizeY + m_margin * 2.f};
+
+	insertLeaf(leaf);
+
+	return true;
+}
+
+void AABBTree::clear() {
+	m_nodes.clear();
+	m_root = nullNode;
+	m_freeList = nullNode;
+	m_leafCount = 0;
+}
+
+s32 AABBTree::allocateNode() {
+	if (m_freeList == nullNode) {
+		m_nodes.emplace_back();
+		return static_cast<s32>(m_nodes.size() - 1);
+	}
+
+	s32 node = m_freeList;
+	m_freeList = m_nodes[node].parent;
+	m_nodes[node] = Node{};
+
+	return node;
+}
+
+void AABBTree::freeNode(s32 node) {
+	m_nodes[node].object = nullptr;
+	m_nodes[node].height = -1;
+	m_nodes[node].parent = m_freeList;
+	m_freeList = node;
+}
+
+void AABBTree::insertLeaf(s32 leaf) {
+	if (m_root == nullNode) {
+		m_root = leaf;
+		m_nodes[leaf].parent = nullNode;
+		return;
+	}
+
+	// Find the best sibling, using the perimeter as the cost of a node
+	FloatRect leafRect = m_nodes[leaf].rect;
+	s32 index = m_root;
+	while (!m_nodes[index].isLeaf()) {
+		const Node &node = m_nodes[index];
+
+		float combinedPerimeter = perimeter(merge(node.rect, leafRect));
+
+		// Cost of creating a new parent for this node and the new leaf
+		float cost = 2.f * combinedPerimeter;
+
+		// Minimum cost of pushing the leaf further down the tree
+		float inheritanceCost = 2.f * (combinedPerimeter - perimeter(node.rect));
+
+		auto childCost = [&] (s32 child) {
+			const FloatRect &rect = m_nodes[child].rect;
+			if (m_nodes[child].isLeaf())
+				return perimeter(merge(leafRect, rect)) + inheritanceCost;
+
+			return perimeter(merge(leafRect, rect)) - perimeter(rect) + inheritanceCost;
+		};
+
+		float cost1 = childCost(node.child1);
+		float cost2 = childCost(node.child2);
+
+		if (cost < cost1 && cost < cost2)
+			break;
+
+		index = (cost1 < cost2) ? node.child1 : node.child2;
+	}
+
+	s32 sibling = index;
+	s32 oldParent = m_nodes[sibling].parent;
+	s32 newParent = allocateNode();
+
+	m_nodes[newParent].parent = oldParent;
+	m_nodes[newParent].rect = merge(leafRect, m_nodes[sibling].rect);
+	m_nodes[newParent].height = m_nodes[sibling].height + 1;
+	m_nodes[newParent].child1 = sibling;
+	m_nodes[newParent].child2 = leaf;
+
+	if (oldParent != nullNode) {
+		if (m_nodes[oldParent].child1 == sibling)
+			m_nodes[oldParent].child1 = newParent;
+		else
+			m_nodes[oldParent].child2 = newParent;
+	}
+	else {
+		m_root = newParent;
+	}
+
+	m_nodes[sibling].parent = newParent;
+	m_nodes[leaf].parent = newParent;
+
+	fixUpwards(newParent);
+}
+
+void AABBTree::removeLeaf(s32 leaf) {
+	if (leaf == m_root) {
+		m_root = nullNode;
+		return;
+	}
+
+	s32 parent = m_nodes[leaf].parent;
+	s32 grandParent = m_nodes[parent].parent;
+	s32 sibling = (m_nodes[parent].child1 == leaf) ? m_nodes[parent].child2 : m_nodes[parent].child1;
+
+	m_nodes[sibling].parent = grandParent;
+
+	if (grandParent != nullNode) {
+		if (m_nodes[grandParent].child1 == parent)
+			m_nodes[grandParent].child1 = sibling;
+		else
+			m_nodes[grandParent].child2 = sibling;
+	}
+	else {
+		m_root = sibling;
+	}
+
+	freeNode(parent);
+
+	if (grandParent != nullNode)
+		fixUpwards(grandParent);
+}
+
+void AABBTree::fixUpwards(s32 index) {
+	while (index != nullNode) {
+		index = balance(index);
+
+		Node &node = m_nodes[index];
+		node.height = 1 + std::max(m_nodes[node.child1].height, m_nodes[node.child2].height);
+		node.rect = merge(m_nodes[node.child1].rect, m_nodes[node.child2].rect);
+
+		index = node.parent;
+	}
+}
+
+// Rotates the taller child up if the children heights differ by more than one
+s32 AABBTree::balance(s32 iA) {
+	Node &A = m_nodes[iA];
+	if (A.isLeaf() || A.height < 2)
+		return iA;
+
+	s32 iB = A.child1;
+	s32 iC = A.child2;
+	Node &B = m_nodes[iB];
+	Node &C = m_nodes[iC];
+
+	auto replaceInParent = [this, iA] (s32 parent, s32 node) {
+		if (parent == nullNode)
+			m_root = node;
+		else if (m_nodes[parent].child1 == iA)
+			m_nodes[parent].child1 = node;
+		else
+			m_nodes[parent].child2 = node;
+	};
+
+	if (C.height - B.height > 1) {
+		s32 iF = C.child1;
+		s32 iG = C.child2;
+		Node &F = m_nodes[iF];
+		Node &G = m_nodes[iG];
+
+		C.child1 = iA;
+		C.parent = A.parent;
+		A.parent = iC;
+		replaceInParent(C.parent, iC);
+
+		if (F.height > G.height) {
+			C.child2 = iF;
+			A.child2 = iG;
+			G.parent = iA;
+			A.rect = merge(B.rect, G.rect);
+			C.rect = merge(A.rect, F.rect);
+			A.height = 1 + std::max(B.height, G.height);
+			C.height = 1 + std::max(A.height, F.height);
+		}
+		else {
+			C.child2 = iG;
+			A.child2 = iF;
+			F.parent = iA;
+			A.rect = merge(B.rect, F.rect);
+			C.rect = merge(A.rect, G.rect);
+			A.height = 1 + std::max(B.height, F.height);
+			C.height = 1 + std::max(A.height, G.height);
+		}
+
+		return iC;
+	}
+
+	if (B.height - C.height > 1) {
+		s32 iD = B.child1;
+		s32 iE = B.child2;
+		Node &D = m_nodes[iD];
+		Node &E = m_nodes[iE];
+
+		B.child1 = iA;
+		B.parent = A.parent;
+		A.parent = iB;
+		replaceInParent(B.parent, iB);
+
+		if (D.height > E.height) {
+			B.child2 = iD;
+			A.child1 = iE;
+			E.parent = iA;
+			A.rect = merge(C.rect, E.rect);
+			B.rect = merge(A.rect, D.rect);
+			A.height = 1 + std::max(C.height, E.height);
+			B.height = 1 + std::max(A.height, D.height);
+		}
+		else {
+			B.child2 = iE;
+			A.child1 = iD;
+			D.parent = iA;
+			A.rect = merge(C.rect, D.rect);
+			B.rect = merge(A.rect, E.rect);
+			A.height = 1 + std::max(C.height, D.height);
+			B.height = 1 + std::max(A.height, E.height);
+		}
+
+		return iB;
+	}
+
+	return iA;
+}
+
+} // namespace gk
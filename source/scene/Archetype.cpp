@@ -0,0 +1,164 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+
+#include "gk/scene/Archetype.hpp"
+
+namespace gk {
+
+// Chunks hold as many rows as fit in this size, and at least one
+static constexpr size_t chunkTargetSize = 16 * 1024;
+
+// Function-local statics, objects can be built during static initialization.
+// The registry is intentionally leaked, objects with static storage duration
+// may still free their rows during exit.
+static std::mutex &registryMutex() {
+	static std::mutex mutex;
+	return mutex;
+}
+
+static std::unordered_map<ComponentSignature, std::unique_ptr<Archetype>> &registry() {
+	static auto *archetypes = new std::unordered_map<ComponentSignature, std::unique_ptr<Archetype>>;
+	return *archetypes;
+}
+
+Archetype::Archetype(const ComponentSignature &signature, std::vector<Column> &&columns)
+	: m_signature(signature), m_columns(std::move(columns))
+{
+	for (auto &edge : m_edges)
+		edge.store(nullptr, std::memory_order_relaxed);
+
+	if (m_columns.empty())
+		return;
+
+	size_t rowSize = 0;
+	for (const Column &column : m_columns) {
+		rowSize += column.size;
+		m_alignment = std::max<size_t>(m_alignment, column.alignment);
+	}
+
+	m_chunkCapacity = u32(std::max<size_t>(1, chunkTargetSize / rowSize));
+
+	// The arrays follow each other in the chunk, in the order of the type IDs
+	for (Column &column : m_columns) {
+		m_chunkSize = (m_chunkSize + column.alignment - 1) / column.alignment * column.alignment;
+		column.offset = m_chunkSize;
+		m_chunkSize += size_t(column.size) * m_chunkCapacity;
+	}
+}
+
+Archetype &Archetype::without(u16 typeID) {
+	if (Archetype *archetype = m_edges[typeID].load(std::memory_order_acquire))
+		return *archetype;
+
+	std::vector<Column> columns;
+	for (const Column &column : m_columns)
+		if (column.typeID != typeID)
+			columns.emplace_back(column);
+
+	return edge(typeID, std::move(columns));
+}
+
+Archetype &Archetype::with(const Column &newColumn) {
+	if (Archetype *archetype = m_edges[newColumn.typeID].load(std::memory_order_acquire))
+		return *archetype;
+
+	std::vector<Column> columns = m_columns;
+	auto it = std::find_if(columns.begin(), columns.end(), [&] (const Column &column) {
+		return column.typeID > newColumn.typeID;
+	});
+	columns.insert(it, newColumn);
+
+	return edge(newColumn.typeID, std::move(columns));
+}
+
+Archetype &Archetype::edge(u16 typeID, std::vector<Column> &&columns) {
+	ComponentSignature signature = m_signature;
+	signature.flip(typeID);
+
+	std::lock_guard<std::mutex> lock(registryMutex());
+
+	std::unique_ptr<Archetype> &archetype = registry()[signature];
+	if (!archetype)
+		archetype.reset(new Archetype(signature, std::move(columns)));
+
+	m_edges[typeID].store(archetype.get(), std::memory_order_release);
+
+	return *archetype;
+}
+
+Archetype::Row Archetype::allocate() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	u32 index;
+	if (!m_freeRows.empty()) {
+		std::pop_heap(m_freeRows.begin(), m_freeRows.end(), std::greater<u32>());
+		index = m_freeRows.back();
+		m_freeRows.pop_back();
+	}
+	else {
+		if (m_rowCount == m_chunks.size() * m_chunkCapacity) {
+			u8 *chunk = static_cast<u8 *>(::operator new(m_chunkSize, std::align_val_t(m_alignment)));
+			m_chunks.emplace_back(chunk, ChunkDeleter{m_alignment});
+		}
+
+		index = m_rowCount++;
+	}
+
+	u32 chunkIndex = index / m_chunkCapacity;
+	return {m_chunks[chunkIndex].get(), chunkIndex, index % m_chunkCapacity};
+}
+
+void Archetype::free(const Row &row) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_freeRows.push_back(row.chunkIndex * m_chunkCapacity + row.index);
+	std::push_heap(m_freeRows.begin(), m_freeRows.end(), std::greater<u32>());
+}
+
+u32 Archetype::size() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_rowCount - u32(m_freeRows.size());
+}
+
+Archetype &Archetype::empty() {
+	static Archetype &archetype = [] () -> Archetype & {
+		std::lock_guard<std::mutex> lock(registryMutex());
+
+		std::unique_ptr<Archetype> &archetype = registry()[ComponentSignature{}];
+		if (!archetype)
+			archetype.reset(new Archetype(ComponentSignature{}, {}));
+
+		return *archetype;
+	}();
+
+	return archetype;
+}
+
+} // namespace gk
@@ -0,0 +1,144 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#include <algorithm>
+
+#include "gk/scene/BroadphaseCollisionHelper.hpp"
+#include "gk/scene/Scene.hpp"
+
+namespace gk {
+
+void BroadphaseCollisionHelper::update(SceneObjectList &objects) {
+	sync(objects);
+}
+
+void BroadphaseCollisionHelper::addObject(SceneObject &object) {
+	if (!m_isBuilt || object.scene() != m_scene)
+		return;
+
+	// Only the top-level objects and their children are in the broadphase
+	if (object.parent() && object.parent()->parent())
+		return;
+
+	m_addedObjects.emplace_back(&object);
+	++m_changeCount;
+}
+
+void BroadphaseCollisionHelper::removeObject(const SceneObject &object) {
+	if (!m_isBuilt || object.scene() != m_scene)
+		return;
+
+	auto it = std::find(m_addedObjects.begin(), m_addedObjects.end(), &object);
+	if (it != m_addedObjects.end()) {
+		*it = m_addedObjects.back();
+		m_addedObjects.pop_back();
+	}
+
+	// The object may also be in the structure of the subclass
+	m_removedObjects.emplace(&object);
+	++m_changeCount;
+}
+
+void BroadphaseCollisionHelper::forEachPair(SceneObject &object, SceneObjectList &objects, const PairFunction &func) {
+	if (!m_isBuilt || objects.scene() != m_scene)
+		sync(objects);
+
+	// The pairs are collected first, since the collision actions can add or remove objects
+	std::vector<Pair> pairs;
+	pairs.swap(m_pairs);
+
+	FloatRect rect;
+	if (getHitboxRect(object, rect)) {
+		findAllCandidates(object, rect);
+
+		for (const Candidate &candidate : m_candidates)
+			if (candidate.object != &object && candidate.parent != &object && canCollide(object, *candidate.object))
+				pairs.push_back({&object, candidate.object, object.handle(), candidate.object->handle()});
+	}
+
+	if (auto *children = object.tryGet<SceneObjectList>()) {
+		for (SceneObject &child : *children) {
+			if (getHitboxRect(child, rect)) {
+				findAllCandidates(child, rect);
+
+				for (const Candidate &candidate : m_candidates)
+					if (!candidate.parent && candidate.object != &object && canCollide(child, *candidate.object))
+						pairs.push_back({&child, candidate.object, child.handle(), candidate.object->handle()});
+			}
+		}
+	}
+
+	u32 changeCount = m_changeCount;
+	for (Pair &pair : pairs) {
+		// Skip the objects removed by a previous action, even if their slot was reused since
+		if (m_changeCount != changeCount
+		 && (!isMember(pair.object1) || pair.object1->handle() != pair.handle1
+		  || !isMember(pair.object2) || pair.object2->handle() != pair.handle2))
+			continue;
+
+		func(*pair.object1, *pair.object2);
+	}
+
+	pairs.clear();
+	m_pairs.swap(pairs);
+}
+
+void BroadphaseCollisionHelper::sync(SceneObjectList &objects) {
+	m_scene = objects.scene();
+
+	m_addedObjects.clear();
+	m_removedObjects.clear();
+
+	rebuild(objects);
+
+	m_isBuilt = true;
+}
+
+void BroadphaseCollisionHelper::findAllCandidates(const SceneObject &object, const FloatRect &rect) {
+	m_candidates.clear();
+	findCandidates(object, rect, m_candidates);
+
+	if (!m_removedObjects.empty()) {
+		m_candidates.erase(std::remove_if(m_candidates.begin(), m_candidates.end(), [this] (const Candidate &candidate) {
+			return m_removedObjects.count(candidate.object) != 0;
+		}), m_candidates.end());
+	}
+
+	auto addCandidate = [&] (SceneObject &added, SceneObject *parent, const FloatRect &addedRect) {
+		if (addedRect.intersects(rect))
+			m_candidates.push_back({&added, parent});
+	};
+
+	for (SceneObject *added : m_addedObjects)
+		addHitbox(*added, added->parent(), addCandidate);
+}
+
+bool BroadphaseCollisionHelper::isMember(const SceneObject *object) const {
+	return m_removedObjects.count(object) == 0
+		|| std::find(m_addedObjects.begin(), m_addedObjects.end(), object) != m_addedObjects.end();
+}
+
+} // namespace gk
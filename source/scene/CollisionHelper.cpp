@@ -33,56 +33,103 @@
 
 namespace gk {
 
+void CollisionHelper::forEachPair(SceneObject &object, SceneObjectList &objects, const PairFunction &func) {
+	auto *children = object.tryGet<SceneObjectList>();
+
+	for(SceneObject &object2 : objects) {
+		if(&object != &object2) {
+			if (canCollide(object, object2))
+				func(object, object2);
+
+			if (children)
+				for (SceneObject &child : *children)
+					if (canCollide(child, object2))
+						func(child, object2);
+
+			if (auto *children2 = object2.tryGet<SceneObjectList>())
+				for (SceneObject &child : *children2)
+					if (canCollide(object, child))
+						func(object, child);
+		}
+	}
+}
+
+void CollisionHelper::checkCollisionsFor(SceneObject &object, SceneObjectList &objects) {
+	forEachPair(object, objects, [this] (SceneObject &object1, SceneObject &object2) {
+		checkCollision(object1, object2);
+	});
+}
+
 void CollisionHelper::checkCollision(SceneObject &object1, SceneObject &object2) {
+	auto *collisionComponent1 = object1.tryGet<CollisionComponent>();
+	auto *collisionComponent2 = object2.tryGet<CollisionComponent>();
+
+	// Objects only using contact actions don't need the test here
+	bool hasActions1 = collisionComponent1 && collisionComponent1->hasActions();
+	bool hasActions2 = collisionComponent2 && collisionComponent2->hasActions();
+	if(!hasActions1 && !hasActions2)
+		return;
+
 	bool collision = inCollision(object1, object2);
+	if(collision) {
+		wakeUp(object1);
+		wakeUp(object2);
+	}
 
-	if(object1.has<CollisionComponent>()) {
-		object1.get<CollisionComponent>().collisionActions(object1, object2, collision);
+	if(hasActions1) {
+		collisionComponent1->collisionActions(object1, object2, collision);
 	}
 
-	if(object2.has<CollisionComponent>()) {
-		object2.get<CollisionComponent>().collisionActions(object2, object1, collision);
+	if(hasActions2) {
+		collisionComponent2->collisionActions(object2, object1, collision);
 	}
 }
 
 bool CollisionHelper::inCollision(SceneObject &object1, SceneObject &object2) {
-	if(object1.has<PositionComponent>() && object1.has<HitboxComponent>()
-	&& object2.has<PositionComponent>() && object2.has<HitboxComponent>()) {
-		auto &hitbox1 = object1.get<HitboxComponent>();
-		auto &hitbox2 = object2.get<HitboxComponent>();
-
-		if(hitbox1.currentHitbox() && hitbox2.currentHitbox()) {
-			FloatRect rect1 = *hitbox1.currentHitbox();
-			FloatRect rect2 = *hitbox2.currentHitbox();
-
-			auto &pos1 = object1.get<PositionComponent>();
-			auto &pos2 = object2.get<PositionComponent>();
-
-			rect1.x += pos1.x;
-			rect1.y += pos1.y;
-
-			rect2.x += pos2.x;
-			rect2.y += pos2.y;
-
-			if(object1.has<MovementComponent>()) {
-				auto &movement = object1.get<MovementComponent>();
-				rect1.x += movement.v.x;
-				rect1.y += movement.v.y;
-			}
-
-			if(object2.has<MovementComponent>()) {
-				auto &movement = object2.get<MovementComponent>();
-				rect2.x += movement.v.x;
-				rect2.y += movement.v.y;
-			}
-
-			if(rect1.intersects(rect2)) {
-				return true;
-			}
-		}
+	FloatRect rect1, rect2;
+	return getHitboxRect(object1, rect1) && getHitboxRect(object2, rect2) && rect1.intersects(rect2);
+}
+
+bool CollisionHelper::canCollide(const SceneObject &object1, const SceneObject &object2) {
+	auto *hitbox1 = object1.tryGet<HitboxComponent>();
+	auto *hitbox2 = object2.tryGet<HitboxComponent>();
+	return !hitbox1 || !hitbox2 || (hitbox1->canCollideWith(*hitbox2) && !(isResting(object1) && isResting(object2)));
+}
+
+bool CollisionHelper::isResting(const SceneObject &object) {
+	auto *hitbox = object.tryGet<HitboxComponent>();
+	if(hitbox && hitbox->isStatic())
+		return true;
+
+	auto *movement = object.tryGet<MovementComponent>();
+	return movement && movement->isSleeping;
+}
+
+void CollisionHelper::wakeUp(SceneObject &object) {
+	auto *movement = object.tryGet<MovementComponent>();
+	if(movement && movement->isSleeping)
+		movement->wakeUp();
+}
+
+bool CollisionHelper::getHitboxRect(const SceneObject &object, FloatRect &rect, bool withVelocity) {
+	auto *position = object.tryGet<PositionComponent>();
+	auto *hitbox = object.tryGet<HitboxComponent>();
+	if(!position || !hitbox || !hitbox->currentHitbox())
+		return false;
+
+	rect = *hitbox->currentHitbox();
+	rect.x += position->x;
+	rect.y += position->y;
+
+	if(!withVelocity)
+		return true;
+
+	if(auto *movement = object.tryGet<MovementComponent>()) {
+		rect.x += movement->v.x;
+		rect.y += movement->v.y;
 	}
 
-	return false;
+	return true;
 }
 
 } // namespace gk
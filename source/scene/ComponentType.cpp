@@ -0,0 +1,68 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#include <mutex>
+#include <vector>
+
+#include "gk/core/Exception.hpp"
+#include "gk/scene/ComponentType.hpp"
+
+namespace gk {
+
+// Function-local statics, types can be registered during static initialization
+static std::mutex &typeMutex() {
+	static std::mutex mutex;
+	return mutex;
+}
+
+static std::vector<const char *> &typeNames() {
+	static std::vector<const char *> typeNames;
+	return typeNames;
+}
+
+u16 ComponentType::count() {
+	std::lock_guard<std::mutex> lock(typeMutex());
+	return u16(typeNames().size());
+}
+
+const char *ComponentType::name(u16 id) {
+	std::lock_guard<std::mutex> lock(typeMutex());
+	auto &names = typeNames();
+	return (id < names.size()) ? names[id] : "unknown";
+}
+
+u16 ComponentType::registerType(const char *name) {
+	std::lock_guard<std::mutex> lock(typeMutex());
+	auto &names = typeNames();
+	if (names.size() == GK_MAX_COMPONENT_TYPES)
+		throw EXCEPTION("Too many component types, increase GK_MAX_COMPONENT_TYPES. Failed to register:", name);
+
+	names.emplace_back(name);
+
+	return u16(names.size() - 1);
+}
+
+} // namespace gk
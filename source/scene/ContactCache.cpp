@@ -0,0 +1,147 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#include <algorithm>
+#include <functional>
+
+#include "gk/scene/ContactCache.hpp"
+
+namespace gk {
+
+static bool hasContactActions(const SceneObject &object) {
+	auto *collisionComponent = object.tryGet<CollisionComponent>();
+	return collisionComponent && collisionComponent->hasContactActions();
+}
+
+static bool hasContactActionsInTree(const SceneObject &object) {
+	if (hasContactActions(object))
+		return true;
+
+	if (auto *children = object.tryGet<SceneObjectList>())
+		for (const SceneObject &child : *children)
+			if (hasContactActions(child))
+				return true;
+
+	return false;
+}
+
+void ContactCache::update(CollisionHelper &helper, SceneObjectList &objects) {
+	m_newContacts.clear();
+	m_newContactSet.clear();
+
+	// The pairs of an object and its children are the ones of the top-level object
+	for (SceneObject &object : objects) {
+		if (!hasContactActionsInTree(object))
+			continue;
+
+		helper.forEachPair(object, objects, [&] (SceneObject &object1, SceneObject &object2) {
+			if (&object1 != &object2 && (hasContactActions(object1) || hasContactActions(object2))
+			 && helper.inCollision(object1, object2))
+				addContact(object1, object2);
+		});
+	}
+
+	// Pairs of resting objects aren't tested, so they're still colliding
+	for (const Contact &contact : m_contacts)
+		if (!m_newContactSet.count(contact) && isAlive(contact.object1) && isAlive(contact.object2)
+		 && CollisionHelper::isResting(*contact.object1.object) && CollisionHelper::isResting(*contact.object2.object))
+			addContact(*contact.object1.object, *contact.object2.object);
+
+	for (const Contact &contact : m_contacts)
+		if (!m_newContactSet.count(contact))
+			callActions(contact, &CollisionComponent::exitActions);
+
+	for (const Contact &contact : m_newContacts) {
+		if (!m_contactSet.count(contact)) {
+			if (isAlive(contact.object1) && isAlive(contact.object2)) {
+				CollisionHelper::wakeUp(*contact.object1.object);
+				CollisionHelper::wakeUp(*contact.object2.object);
+			}
+
+			callActions(contact, &CollisionComponent::enterActions);
+		}
+		else {
+			callActions(contact, &CollisionComponent::stayActions);
+		}
+	}
+
+	// Actions may have removed some objects
+	if (!m_removedObjects.empty()) {
+		m_newContacts.erase(std::remove_if(m_newContacts.begin(), m_newContacts.end(), [this] (const Contact &contact) {
+			if (isAlive(contact.object1) && isAlive(contact.object2))
+				return false;
+
+			m_newContactSet.erase(contact);
+			return true;
+		}), m_newContacts.end());
+
+		m_removedObjects.clear();
+	}
+
+	std::swap(m_contacts, m_newContacts);
+	std::swap(m_contactSet, m_newContactSet);
+}
+
+void ContactCache::removeObject(const SceneObject &object) {
+	if (!m_contacts.empty() || !m_newContacts.empty())
+		m_removedObjects.insert({const_cast<SceneObject *>(&object), object.handle().generation});
+}
+
+void ContactCache::addContact(SceneObject &object1, SceneObject &object2) {
+	// The same pair can be found from both objects
+	Contact contact{{&object1, object1.handle().generation}, {&object2, object2.handle().generation}};
+	if (std::less<SceneObject *>()(&object2, &object1))
+		std::swap(contact.object1, contact.object2);
+
+	if (m_newContactSet.insert(contact).second)
+		m_newContacts.emplace_back(contact);
+}
+
+void ContactCache::callActions(const Contact &contact, ContactActions actions) const {
+	if (!isAlive(contact.object1) || !isAlive(contact.object2))
+		return;
+
+	SceneObject &object1 = *contact.object1.object;
+	SceneObject &object2 = *contact.object2.object;
+	if (auto *collisionComponent = object1.tryGet<CollisionComponent>())
+		(collisionComponent->*actions)(object1, object2);
+
+	if (!isAlive(contact.object1) || !isAlive(contact.object2))
+		return;
+
+	if (auto *collisionComponent = object2.tryGet<CollisionComponent>())
+		(collisionComponent->*actions)(object2, object1);
+}
+
+size_t ContactCache::Hash::operator()(const ObjectKey &key) const {
+	return std::hash<SceneObject *>()(key.object) ^ (std::hash<u32>()(key.generation) << 1);
+}
+
+size_t ContactCache::Hash::operator()(const Contact &contact) const {
+	return operator()(contact.object1) * 31 + operator()(contact.object2);
+}
+
+} // namespace gk
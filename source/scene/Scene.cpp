@@ -24,12 +24,29 @@
  *
  * =====================================================================================
  */
+#include <algorithm>
+#include <cmath>
+
+#include "gk/core/GameClock.hpp"
 #include "gk/scene/component/CollisionComponent.hpp"
+#include "gk/scene/component/HitboxComponent.hpp"
+#include "gk/scene/component/PositionComponent.hpp"
 #include "gk/scene/Scene.hpp"
 
 namespace gk {
 
+// Parallel task running on this thread, if scene isn't nullptr
+struct TaskContext {
+	const Scene *scene = nullptr;
+	SceneCommandBuffer *commands = nullptr;
+	SceneProfiler::Clock::duration collisionTime{};
+};
+
+static thread_local TaskContext taskContext;
+
 Scene::Scene() {
+	m_objects.m_scene = this;
+
 	setCollisionHelper<CollisionHelper>();
 }
 
@@ -38,62 +55,435 @@ void Scene::reset() {
 		if (controller->isGlobal())
 			controller->reset(m_objects);
 
-	for (SceneObject &object : m_objects) {
-		reset(object);
+	for (auto &controller : m_controllerList) {
+		if (controller->isGlobal())
+			continue;
+
+		if (controller->m_query) {
+			controller->m_query->forEach([&] (SceneObject &object) {
+				controller->reset(object);
+			});
+		}
+		else {
+			for (size_t i = 0 ; i < m_objects.size() ; ++i) {
+				controller->reset(m_objects[i]);
+
+				if (auto *children = m_objects[i].tryGet<SceneObjectList>())
+					controller->reset(*children);
+			}
+		}
+	}
+}
+
+template<typename T, typename Func>
+void Scene::profile(const T &system, Func &&func) const {
+	if (!m_profiler) {
+		func();
+		return;
+	}
+
+	auto collisionTime = m_collisionTime;
+	auto start = SceneProfiler::Clock::now();
+	size_t objectCount = func();
+	auto duration = SceneProfiler::Clock::now() - start;
+
+	// The collisions checked by the system are part of the collision phase
+	m_profiler->addSample(&system, typeid(system), duration - (m_collisionTime - collisionTime), objectCount);
+}
+
+template<typename Func>
+void Scene::timeCollisions(Func &&func) {
+	if (!m_profiler) {
+		func();
+		return;
+	}
+
+	auto start = SceneProfiler::Clock::now();
+	func();
+	auto duration = SceneProfiler::Clock::now() - start;
+
+	if (taskContext.scene == this)
+		taskContext.collisionTime += duration;
+	else
+		m_collisionTime += duration;
+}
+
+void Scene::flushCommands() {
+	if (!m_profiler) {
+		m_commands.flush(m_objects);
+		return;
 	}
+
+	auto start = SceneProfiler::Clock::now();
+	m_commands.flush(m_objects);
+	m_flushTime += SceneProfiler::Clock::now() - start;
 }
 
 void Scene::update() {
+	if (m_isInterpolationEnabled) {
+		query<PositionComponent>().forEach([] (SceneObject &object) {
+			object.get<PositionComponent>().savePrevious();
+		});
+	}
+
+	for (auto &controller : m_controllerList) {
+		if (controller->isGlobal()) {
+			profile(*controller, [&] {
+				controller->update(m_objects);
+				return m_objects.size();
+			});
+		}
+	}
+
+	m_flushTime = {};
+	flushCommands();
+
+	// The collision phase is the broadphase update, the collision checks and the contact cache update
+	m_collisionTime = {};
+	timeCollisions([&] { m_collisionHelper->update(m_objects); });
+
+	m_isTreeUpToDate = false;
+
+	if (m_threadPool) {
+		updateInParallel();
+	}
+	else {
+		for (auto &controller : m_controllerList)
+			if (!controller->isGlobal())
+				profile(*controller, [&] { return updateController(*controller); });
+	}
+
 	for (auto &controller : m_controllerList)
+		controller->endUpdate();
+
+	timeCollisions([&] { m_contactCache.update(*m_collisionHelper, m_objects); });
+
+	flushCommands();
+
+	if (m_profiler) {
+		m_profiler->addSample(m_collisionHelper.get(), typeid(*m_collisionHelper), m_collisionTime, m_contactCache.size());
+		m_profiler->addSample(&m_commands, typeid(m_commands), m_flushTime, m_objects.size());
+		m_profiler->endTick();
+	}
+}
+
+SceneCommandBuffer &Scene::commands() {
+	return taskContext.scene == this ? *taskContext.commands : m_commands;
+}
+
+void Scene::setThreadCount(u16 threadCount) {
+	m_threadPool.reset(threadCount > 1 ? new ThreadPool(static_cast<u16>(threadCount - 1)) : nullptr);
+}
+
+void Scene::setProfilingEnabled(bool isEnabled) {
+	m_profiler.reset(isEnabled ? new SceneProfiler : nullptr);
+}
+
+size_t Scene::updateController(AbstractController &controller) {
+	size_t objectCount = 0;
+	if (controller.m_query) {
+		controller.m_query->forEach([&] (SceneObject &object) {
+			controller.update(object);
+			++objectCount;
+		});
+	}
+	else {
+		for (size_t i = 0 ; i < m_objects.size() ; ++i) {
+			controller.update(m_objects[i]);
+
+			if (auto *children = m_objects[i].tryGet<SceneObjectList>())
+				controller.update(*children);
+		}
+
+		objectCount = m_objects.size();
+	}
+
+	controller.flush();
+
+	return objectCount;
+}
+
+void Scene::updateInParallel() {
+	// Objects per task for data-parallel controllers
+	static const size_t chunkSize = 256;
+
+	// Each controller runs in the wave following the last one of the previous
+	// controllers it conflicts with, so results don't depend on the scheduling
+	m_parallelControllers.clear();
+	m_controllerWaves.clear();
+
+	u16 waveCount = 0;
+	for (auto &controller : m_controllerList) {
 		if (controller->isGlobal())
-			controller->update(m_objects);
+			continue;
 
-	for (SceneObject &object : m_objects) {
-		update(object);
+		u16 wave = 0;
+		for (size_t i = 0 ; i < m_parallelControllers.size() ; ++i)
+			if (controller->conflictsWith(*m_parallelControllers[i]))
+				wave = std::max(wave, static_cast<u16>(m_controllerWaves[i] + 1));
+
+		m_parallelControllers.emplace_back(controller.get());
+		m_controllerWaves.emplace_back(wave);
+
+		waveCount = std::max(waveCount, static_cast<u16>(wave + 1));
+	}
+
+	for (u16 wave = 0 ; wave < waveCount ; ++wave) {
+		m_parallelObjects.clear();
+		m_parallelTasks.clear();
+
+		// The objects are gathered first, since queries can't be iterated from several threads
+		for (size_t i = 0 ; i < m_parallelControllers.size() ; ++i) {
+			if (m_controllerWaves[i] != wave)
+				continue;
+
+			AbstractController &controller = *m_parallelControllers[i];
+
+			// Such a controller conflicts with all the others, so it's alone in its wave
+			if (!controller.hasDeclaredAccess()) {
+				profile(controller, [&] { return updateController(controller); });
+				continue;
+			}
+
+			size_t begin = m_parallelObjects.size();
+			if (controller.m_query) {
+				controller.m_query->forEach([&] (SceneObject &object) {
+					m_parallelObjects.emplace_back(&object);
+				});
+			}
+			else {
+				for (SceneObject &object : m_objects)
+					m_parallelObjects.emplace_back(&object);
+			}
+
+			size_t end = m_parallelObjects.size();
+			size_t step = controller.isDataParallel() ? chunkSize : end - begin;
+			for (size_t j = begin ; j < end ; j += step)
+				m_parallelTasks.push_back({&controller, j, std::min(j + step, end), !controller.m_query, {}, {}});
+		}
+
+		if (m_taskCommands.size() < m_parallelTasks.size())
+			m_taskCommands.resize(m_parallelTasks.size());
+
+		bool isProfiling = m_profiler != nullptr;
+		m_threadPool->run(m_parallelTasks.size(), [this, isProfiling] (size_t i) {
+			ParallelTask &task = m_parallelTasks[i];
+
+			taskContext.scene = this;
+			taskContext.commands = &m_taskCommands[i];
+			taskContext.collisionTime = {};
+
+			SceneProfiler::Clock::time_point start;
+			if (isProfiling)
+				start = SceneProfiler::Clock::now();
+
+			for (size_t j = task.begin ; j < task.end ; ++j) {
+				SceneObject &object = *m_parallelObjects[j];
+				task.controller->update(object);
+
+				if (task.hasChildren)
+					if (auto *children = object.tryGet<SceneObjectList>())
+						task.controller->update(*children);
+			}
+
+			task.controller->flush();
+
+			if (isProfiling) {
+				task.duration = SceneProfiler::Clock::now() - start;
+				task.collisionDuration = taskContext.collisionTime;
+			}
+
+			taskContext.scene = nullptr;
+		});
+
+		for (size_t i = 0 ; i < m_parallelTasks.size() ; ++i)
+			m_commands.append(m_taskCommands[i]);
+
+		// The time of a controller is the sum of the times of its tasks, which are contiguous
+		if (isProfiling) {
+			for (size_t i = 0 ; i < m_parallelTasks.size() ; ) {
+				AbstractController *controller = m_parallelTasks[i].controller;
+
+				SceneProfiler::Clock::duration duration{};
+				size_t objectCount = 0;
+				for ( ; i < m_parallelTasks.size() && m_parallelTasks[i].controller == controller ; ++i) {
+					// The collisions checked by the tasks are part of the collision phase
+					duration += m_parallelTasks[i].duration - m_parallelTasks[i].collisionDuration;
+					m_collisionTime += m_parallelTasks[i].collisionDuration;
+					objectCount += m_parallelTasks[i].end - m_parallelTasks[i].begin;
+				}
+
+				m_profiler->addSample(controller, typeid(*controller), duration, objectCount);
+			}
+		}
 	}
 }
 
 void Scene::reset(SceneObject &object) {
 	for (auto &controller : m_controllerList) {
-		if (!controller->isGlobal()) {
+		if (!controller->isGlobal() && controller->filter().matches(object.signature())) {
 			controller->reset(object);
 
-			if (object.has<SceneObjectList>())
-				controller->reset(object.get<SceneObjectList>());
+			if (auto *children = object.tryGet<SceneObjectList>())
+				controller->reset(*children);
 		}
 	}
 }
 
 void Scene::update(SceneObject &object) {
 	for (auto &controller : m_controllerList) {
-		if (!controller->isGlobal()) {
+		if (!controller->isGlobal() && controller->filter().matches(object.signature())) {
 			controller->update(object);
 
-			if (object.has<SceneObjectList>())
-				controller->update(object.get<SceneObjectList>());
+			if (auto *children = object.tryGet<SceneObjectList>())
+				controller->update(*children);
+
+			controller->flush();
 		}
 	}
 }
 
 void Scene::draw(const SceneObject &object, RenderTarget &target, RenderStates states) const {
 	for (auto &view : m_viewList) {
-		view->draw(object, target, states);
+		if (view->filter().matches(object.signature()))
+			view->draw(object, target, states);
+
+		if (auto *children = object.tryGet<SceneObjectList>())
+			view->draw(*children, target, states);
 
-		if (object.has<SceneObjectList>())
-			view->draw(object.get<SceneObjectList>(), target, states);
+		view->endDraw(target, states);
 	}
 }
 
 void Scene::draw(RenderTarget &target, RenderStates states) const {
-	for (auto &view : m_viewList)
-		view->draw(m_objects, target, states);
+	FloatRect visibleRect;
+	bool hasVisibleRect = target.getVisibleRect(states.transform, visibleRect);
+
+	float interpolationAlpha = m_isInterpolationEnabled ? GameClock::getInstance().getInterpolationAlpha() : 1.f;
+
+	for (auto &view : m_viewList) {
+		view->m_hasVisibleRect = hasVisibleRect;
+		view->m_visibleRect = visibleRect;
+		view->m_interpolationAlpha = interpolationAlpha;
+		view->m_drawnCount = 0;
+		view->m_culledCount = 0;
+
+		profile(*view, [&] {
+			// The tree is only used if it was already updated during this tick
+			if (hasVisibleRect && view->hasHitboxBounds() && view->m_query && m_isTreeEnabled && m_isTreeUpToDate) {
+				m_visibleObjects.clear();
+				m_tree.query(visibleRect, [&] (s32 leaf) {
+					const SceneObject *object = m_tree.object(leaf);
+					if (view->m_query->contains(*object))
+						m_visibleObjects.emplace_back(object);
+				});
+
+				// The tree doesn't keep any order, objects are drawn in the order they were added
+				std::sort(m_visibleObjects.begin(), m_visibleObjects.end(), [] (const SceneObject *object1, const SceneObject *object2) {
+					return object1->m_insertionIndex < object2->m_insertionIndex;
+				});
+
+				for (const SceneObject *object : m_visibleObjects)
+					view->drawIfVisible(*object, target, states);
+
+				view->m_culledCount = view->m_query->size() - view->m_drawnCount;
+			}
+			else if (view->m_query) {
+				view->m_query->forEach([&] (const SceneObject &object) {
+					view->drawIfVisible(object, target, states);
+				});
+			}
+			else {
+				view->draw(m_objects, target, states);
+			}
+
+			view->endDraw(target, states);
+
+			return view->m_drawnCount + view->m_culledCount;
+		});
+
+		view->m_hasVisibleRect = false;
+		view->m_interpolationAlpha = 1.f;
+	}
+}
+
+SceneQuery &Scene::query(const ComponentFilter &filter) {
+	for (SceneQuery &query : m_queries)
+		if (query.filter() == filter)
+			return query;
+
+	SceneQuery &query = m_queries.emplace_back(filter);
+
+	std::function<void(SceneObjectList &)> addMatchingObjects = [&] (SceneObjectList &objects) {
+		for (SceneObject &object : objects) {
+			if (filter.matches(object.signature()))
+				query.add(object);
+
+			if (auto *children = object.tryGet<SceneObjectList>())
+				addMatchingObjects(*children);
+		}
+	};
+
+	addMatchingObjects(m_objects);
+
+	return query;
+}
+
+std::vector<SceneObject *> Scene::queryRegion(const FloatRect &rect) {
+	std::vector<SceneObject *> objects;
+	queryRegion(rect, objects);
+	return objects;
+}
+
+void Scene::queryRegion(const FloatRect &rect, std::vector<SceneObject *> &objects) {
+	objects.clear();
+
+	updateTree();
+
+	m_tree.query(rect, [&] (s32 leaf) {
+		SceneObject *object = m_tree.object(leaf);
+
+		FloatRect hitbox;
+		if (CollisionHelper::getHitboxRect(*object, hitbox, false) && AABBTree::overlaps(hitbox, rect))
+			objects.emplace_back(object);
+	});
+}
+
+RaycastHit Scene::raycast(const Vector2f &origin, const Vector2f &direction, float maxDistance) {
+	RaycastHit hit;
+
+	float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+	if (length == 0.f)
+		return hit;
+
+	updateTree();
+
+	Vector2f normalizedDirection = direction / length;
+	m_tree.raycast(origin, normalizedDirection, maxDistance, [&] (s32 leaf, float rayLength) {
+		SceneObject *object = m_tree.object(leaf);
+
+		FloatRect hitbox;
+		float distance;
+		if (CollisionHelper::getHitboxRect(*object, hitbox, false)
+		 && AABBTree::rayIntersection(hitbox, origin, normalizedDirection, rayLength, distance)
+		 && (!hit.object || distance < hit.distance)) {
+			hit.object = object;
+			hit.distance = distance;
+
+			return distance;
+		}
+
+		return rayLength;
+	});
+
+	return hit;
 }
 
 SceneObject &Scene::addObject(SceneObject &&object) {
 	SceneObject &obj = m_objects.addObject(std::move(object));
 
-	if(obj.has<CollisionComponent>()) {
-		obj.get<CollisionComponent>().addChecker([&](SceneObject &object) {
+	if(auto *collisionComponent = obj.tryGet<CollisionComponent>()) {
+		collisionComponent->addChecker([&](SceneObject &object) {
 			checkCollisionsFor(object);
 		});
 	}
@@ -103,26 +493,142 @@ SceneObject &Scene::addObject(SceneObject &&object) {
 
 void Scene::addCollisionChecker(std::function<void(SceneObject &)> checker) {
 	for (SceneObject &object : m_objects) {
-		if (object.has<CollisionComponent>()) {
-			object.get<CollisionComponent>().addChecker(checker);
+		if (auto *collisionComponent = object.tryGet<CollisionComponent>()) {
+			collisionComponent->addChecker(checker);
 		}
 	}
 }
 
 void Scene::checkCollisionsFor(SceneObject &object) {
-	for(SceneObject &object2 : m_objects) {
-		if(&object != &object2) {
-			m_collisionHelper->checkCollision(object, object2);
+	timeCollisions([&] { m_collisionHelper->checkCollisionsFor(object, m_objects); });
+}
+
+static const ComponentSignature hitboxSignature = componentSignature<PositionComponent, HitboxComponent>();
+
+void Scene::registerObject(SceneObject &object, SceneObject *parent) {
+	object.m_scene = this;
+	object.m_parent = parent;
+	object.m_insertionIndex = m_nextInsertionIndex++;
+
+	for (SceneQuery &query : m_queries)
+		if (query.filter().matches(object.signature()))
+			query.add(object);
+
+	if (m_isTreeEnabled)
+		updateTreeLeaf(object);
+
+	if ((object.signature() & hitboxSignature) == hitboxSignature)
+		m_collisionHelper->addObject(object);
+
+	if (auto *children = object.tryGet<SceneObjectList>())
+		attach(*children, &object);
+}
 
-			if (object.has<SceneObjectList>())
-				for (SceneObject &child : object.get<SceneObjectList>())
-					m_collisionHelper->checkCollision(child, object2);
+void Scene::unregisterObject(SceneObject &object) {
+	if (auto *children = object.tryGet<SceneObjectList>())
+		detach(*children);
 
-			if (object2.has<SceneObjectList>())
-				for (SceneObject &child : object2.get<SceneObjectList>())
-					m_collisionHelper->checkCollision(object, child);
+	for (SceneQuery &query : m_queries)
+		if (query.filter().matches(object.signature()))
+			query.remove(object);
+
+	if (m_isTreeEnabled) {
+		auto it = m_treeLeaves.find(&object);
+		if (it != m_treeLeaves.end()) {
+			m_tree.remove(it->second);
+			m_treeLeaves.erase(it);
 		}
 	}
+
+	if ((object.signature() & hitboxSignature) == hitboxSignature)
+		m_collisionHelper->removeObject(object);
+
+	m_contactCache.removeObject(object);
+
+	object.m_scene = nullptr;
+	object.m_parent = nullptr;
+}
+
+void Scene::updateQueries(SceneObject &object, const ComponentSignature &oldSignature) {
+	for (SceneQuery &query : m_queries) {
+		bool wasMatching = query.filter().matches(oldSignature);
+		bool isMatching = query.filter().matches(object.signature());
+		if (isMatching && !wasMatching)
+			query.add(object);
+		else if (wasMatching && !isMatching)
+			query.remove(object);
+	}
+
+	if (m_isTreeEnabled && ((oldSignature ^ object.signature()) & hitboxSignature).any())
+		updateTreeLeaf(object);
+
+	bool hadHitbox = (oldSignature & hitboxSignature) == hitboxSignature;
+	bool hasHitbox = (object.signature() & hitboxSignature) == hitboxSignature;
+	if (hasHitbox && !hadHitbox)
+		m_collisionHelper->addObject(object);
+	else if (hadHitbox && !hasHitbox)
+		m_collisionHelper->removeObject(object);
+
+	// The child list may have been added or replaced
+	if (auto *children = object.tryGet<SceneObjectList>())
+		attach(*children, &object);
+}
+
+void Scene::restoreInsertionIndices(u64 nextInsertionIndex) {
+	// Objects outside of the restored list may have been added since the snapshot was saved
+	m_nextInsertionIndex = std::max(m_nextInsertionIndex, nextInsertionIndex);
+
+	for (SceneQuery &query : m_queries)
+		query.m_isSortNeeded = true;
+}
+
+void Scene::attach(SceneObjectList &objects, SceneObject *parent) {
+	if (objects.m_scene == this)
+		return;
+
+	objects.m_scene = this;
+	objects.m_parent = parent;
+
+	for (SceneObject &object : objects)
+		registerObject(object, parent);
+}
+
+void Scene::detach(SceneObjectList &objects) {
+	for (SceneObject &object : objects)
+		unregisterObject(object);
+
+	objects.m_scene = nullptr;
+	objects.m_parent = nullptr;
+}
+
+void Scene::updateTree() {
+	if (m_isTreeUpToDate)
+		return;
+
+	m_isTreeEnabled = true;
+	m_isTreeUpToDate = true;
+
+	query<PositionComponent, HitboxComponent>().forEach([this] (SceneObject &object) {
+		updateTreeLeaf(object);
+	});
+}
+
+void Scene::updateTreeLeaf(SceneObject &object) {
+	FloatRect rect;
+	bool hasHitbox = CollisionHelper::getHitboxRect(object, rect, false);
+
+	auto it = m_treeLeaves.find(&object);
+	if (it == m_treeLeaves.end()) {
+		if (hasHitbox)
+			m_treeLeaves.emplace(&object, m_tree.insert(rect, &object));
+	}
+	else if (hasHitbox) {
+		m_tree.move(it->second, rect);
+	}
+	else {
+		m_tree.remove(it->second);
+		m_treeLeaves.erase(it);
+	}
 }
 
 } // namespace gk
@@ -0,0 +1,100 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#include "gk/scene/Scene.hpp"
+#include "gk/scene/SceneCommandBuffer.hpp"
+
+namespace gk {
+
+void SceneCommandBuffer::spawn(SceneObjectList &list, SceneObject &&object) {
+	m_spawns.push_back({&list, list.m_parent, std::move(object)});
+}
+
+void SceneCommandBuffer::destroy(SceneObject &object) {
+	if (!object.m_isDestroyed) {
+		object.m_isDestroyed = true;
+		++m_destroyedCount;
+	}
+}
+
+void SceneCommandBuffer::addCommand(std::function<void()> &&command) {
+	m_commands.emplace_back(std::move(command));
+}
+
+bool SceneCommandBuffer::empty() const {
+	return m_commands.empty() && m_spawns.empty() && m_destroyedCount == 0;
+}
+
+void SceneCommandBuffer::append(SceneCommandBuffer &buffer) {
+	for (auto &command : buffer.m_commands)
+		m_commands.emplace_back(std::move(command));
+
+	for (Spawn &spawn : buffer.m_spawns)
+		m_spawns.push_back(std::move(spawn));
+
+	m_destroyedCount += buffer.m_destroyedCount;
+
+	buffer.m_commands.clear();
+	buffer.m_spawns.clear();
+	buffer.m_destroyedCount = 0;
+}
+
+void SceneCommandBuffer::flush(SceneObjectList &objects) {
+	// Commands recorded during the flush are kept for the next one
+	m_flushedCommands.clear();
+	m_flushedSpawns.clear();
+
+	m_flushedCommands.swap(m_commands);
+	m_flushedSpawns.swap(m_spawns);
+
+	size_t destroyedCount = m_destroyedCount;
+	m_destroyedCount = 0;
+
+	for (auto &command : m_flushedCommands)
+		command();
+
+	for (Spawn &spawn : m_flushedSpawns) {
+		// The parent may have lost its child list since the spawn was recorded
+		SceneObjectList *list = spawn.parent ? spawn.parent->tryGet<SceneObjectList>() : spawn.list;
+		if (!list)
+			continue;
+
+		// Objects added to the scene directly get its collision checker
+		Scene *scene = list->scene();
+		if (scene && list == &scene->objects())
+			scene->addObject(std::move(spawn.object));
+		else
+			list->addObject(std::move(spawn.object));
+	}
+
+	m_flushedCommands.clear();
+	m_flushedSpawns.clear();
+
+	if (destroyedCount)
+		objects.removeDestroyedObjects();
+}
+
+} // namespace gk
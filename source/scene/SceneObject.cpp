@@ -0,0 +1,99 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#include "gk/scene/Scene.hpp"
+#include "gk/scene/SceneObject.hpp"
+
+namespace gk {
+
+SceneObject &SceneObject::operator=(SceneObject &&object) {
+	checkUnlisted(*this);
+	checkUnlisted(object);
+
+	if (&object != this) {
+		clear();
+
+		m_name = std::move(object.m_name);
+		m_type = std::move(object.m_type);
+
+		m_signature = object.m_signature;
+		m_archetype = object.m_archetype;
+		m_row = object.m_row;
+		m_isDestroyed = object.m_isDestroyed;
+
+		object.m_signature.reset();
+		object.m_archetype = nullptr;
+
+		if (object.m_scene)
+			object.updateQueries(m_signature);
+	}
+
+	return *this;
+}
+
+void SceneObject::moveComponents(Archetype *archetype, const Archetype::Row &row) {
+	if (m_archetype && archetype) {
+		const std::vector<Archetype::Column> &columns = m_archetype->columns();
+		for (size_t i = 0 ; i < columns.size() ; ++i) {
+			u16 typeID = columns[i].typeID;
+			if (archetype->signature()[typeID])
+				columns[i].relocate(archetype->get(row, Archetype::columnIndex(archetype->signature(), typeID)), m_archetype->get(m_row, i));
+		}
+	}
+
+	m_archetype = archetype;
+	m_row = row;
+}
+
+void SceneObject::clear() {
+	if (m_archetype) {
+		const std::vector<Archetype::Column> &columns = m_archetype->columns();
+		for (size_t i = 0 ; i < columns.size() ; ++i)
+			columns[i].destroy(m_archetype->get(m_row, i));
+
+		m_archetype->free(m_row);
+		m_archetype = nullptr;
+	}
+
+	m_signature.reset();
+}
+
+SceneObject &SceneObject::checkUnlisted(SceneObject &object) {
+	if (object.m_handle.isValid())
+		throw EXCEPTION("SceneObject (\"" + object.m_name + "\", \"" + object.m_type + "\") can't be moved or assigned while it's in a SceneObjectList");
+
+	return object;
+}
+
+void SceneObject::updateQueries(const ComponentSignature &oldSignature) {
+	m_scene->updateQueries(*this, oldSignature);
+}
+
+void SceneObject::unregister() {
+	m_scene->unregisterObject(*this);
+}
+
+} // namespace gk
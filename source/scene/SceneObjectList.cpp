@@ -0,0 +1,309 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#include <cassert>
+
+#include "gk/scene/Scene.hpp"
+#include "gk/scene/SceneObjectList.hpp"
+
+namespace gk {
+
+SceneObjectList::SceneObjectList(SceneObjectList &&list)
+	: m_storage(std::move(list.m_storage)), m_slots(std::move(list.m_slots)),
+	  m_freeSlots(std::move(list.m_freeSlots)), m_objects(std::move(list.m_objects)), m_holeCount(list.m_holeCount),
+	  m_nameIndex(std::move(list.m_nameIndex)), m_typeIndex(std::move(list.m_typeIndex)),
+	  m_scene(list.m_scene), m_parent(list.m_parent)
+{
+	list.m_slots.clear();
+	list.m_freeSlots.clear();
+	list.m_objects.clear();
+	list.m_holeCount = 0;
+	list.m_nameIndex.clear();
+	list.m_typeIndex.clear();
+	list.m_scene = nullptr;
+	list.m_parent = nullptr;
+}
+
+SceneObjectList &SceneObjectList::operator=(SceneObjectList &&list) {
+	if (&list != this) {
+		m_objects.clear();
+		m_freeSlots.clear();
+		m_storage.clear();
+
+		m_storage = std::move(list.m_storage);
+		m_slots = std::move(list.m_slots);
+		m_freeSlots = std::move(list.m_freeSlots);
+		m_objects = std::move(list.m_objects);
+		m_holeCount = list.m_holeCount;
+		m_nameIndex = std::move(list.m_nameIndex);
+		m_typeIndex = std::move(list.m_typeIndex);
+		m_scene = list.m_scene;
+		m_parent = list.m_parent;
+
+		list.m_slots.clear();
+		list.m_freeSlots.clear();
+		list.m_objects.clear();
+		list.m_holeCount = 0;
+		list.m_nameIndex.clear();
+		list.m_typeIndex.clear();
+		list.m_scene = nullptr;
+		list.m_parent = nullptr;
+	}
+
+	return *this;
+}
+
+SceneObject &SceneObjectList::addObject(SceneObject &&object) {
+	u32 slot;
+	if (!m_freeSlots.empty()) {
+		slot = m_freeSlots.back();
+		m_freeSlots.pop_back();
+
+		m_storage[slot] = std::move(object);
+	}
+	else {
+		slot = static_cast<u32>(m_storage.size());
+
+		m_storage.emplace_back(std::move(object));
+		m_slots.emplace_back();
+	}
+
+	SceneObject &newObject = m_storage[slot];
+	newObject.m_handle = {slot, m_slots[slot].generation};
+
+	m_slots[slot].position = static_cast<u32>(m_objects.size());
+	m_objects.emplace_back(&newObject);
+
+	addToIndex(m_nameIndex, newObject.name(), slot, &Slot::namePosition);
+	addToIndex(m_typeIndex, newObject.type(), slot, &Slot::typePosition);
+
+	if (m_scene)
+		m_scene->registerObject(newObject, m_parent);
+
+	return newObject;
+}
+
+SceneObject *SceneObjectList::get(SceneObjectHandle handle) {
+	if (handle.index >= m_slots.size() || m_slots[handle.index].generation != handle.generation)
+		return nullptr;
+
+	return &m_storage[handle.index];
+}
+
+const SceneObject *SceneObjectList::get(SceneObjectHandle handle) const {
+	if (handle.index >= m_slots.size() || m_slots[handle.index].generation != handle.generation)
+		return nullptr;
+
+	return &m_storage[handle.index];
+}
+
+SceneObject *SceneObjectList::findByName(const std::string &name) {
+	auto it = m_nameIndex.find(name);
+	if (it == m_nameIndex.end())
+		return nullptr;
+	else
+		return &m_storage[it->second.front()];
+}
+
+void SceneObjectList::removeByName(const std::string &name) {
+	if (SceneObject *object = findByName(name))
+		removeAt(m_slots[object->m_handle.index].position);
+}
+
+void SceneObjectList::remove(size_t n) {
+	compact();
+	removeAt(static_cast<u32>(n));
+}
+
+void SceneObjectList::remove(SceneObjectHandle handle) {
+	if (get(handle))
+		removeAt(m_slots[handle.index].position);
+}
+
+void SceneObjectList::removeAt(u32 position) {
+	SceneObject *object = m_objects[position];
+
+	m_objects[position] = nullptr;
+	++m_holeCount;
+
+	release(*object);
+}
+
+void SceneObjectList::removeHoles() const {
+	u32 size = 0;
+	for (size_t i = 0 ; i < m_objects.size() ; ++i) {
+		if (SceneObject *object = m_objects[i]) {
+			m_slots[object->m_handle.index].position = size;
+			m_objects[size++] = object;
+		}
+	}
+
+	m_objects.resize(size);
+	m_holeCount = 0;
+}
+
+void SceneObjectList::removeDestroyedObjects() {
+	u32 size = 0;
+	for (size_t i = 0 ; i < m_objects.size() ; ++i) {
+		SceneObject *object = m_objects[i];
+		if (!object)
+			continue;
+
+		if (object->isDestroyed()) {
+			release(*object);
+		}
+		else {
+			if (auto *children = object->tryGet<SceneObjectList>())
+				children->removeDestroyedObjects();
+
+			m_slots[object->m_handle.index].position = size;
+			m_objects[size++] = object;
+		}
+	}
+
+	m_objects.resize(size);
+	m_holeCount = 0;
+}
+
+void SceneObjectList::addToIndex(Index &index, const std::string &key, u32 slot, u32 Slot::*position) {
+	std::vector<u32> &bucket = index[key];
+	m_slots[slot].*position = static_cast<u32>(bucket.size());
+	bucket.emplace_back(slot);
+}
+
+void SceneObjectList::removeFromIndex(Index &index, const std::string &key, u32 slot, u32 Slot::*position) {
+	// Names and types only change through rename(), so the key is always indexed
+	auto it = index.find(key);
+	assert(it != index.end());
+
+	std::vector<u32> &bucket = it->second;
+
+	u32 last = bucket.back();
+	bucket[m_slots[slot].*position] = last;
+	m_slots[last].*position = m_slots[slot].*position;
+	bucket.pop_back();
+
+	if (bucket.empty())
+		index.erase(it);
+}
+
+void SceneObjectList::release(SceneObject &object) {
+	u32 slot = object.m_handle.index;
+
+	removeFromIndex(m_nameIndex, object.name(), slot, &Slot::namePosition);
+	removeFromIndex(m_typeIndex, object.type(), slot, &Slot::typePosition);
+
+	if (object.m_scene)
+		object.unregister();
+
+	object.m_handle = SceneObjectHandle{};
+	object = SceneObject();
+
+	// Handles to the removed object aren't valid anymore
+	++m_slots[slot].generation;
+
+	m_freeSlots.emplace_back(slot);
+}
+
+SceneObject &SceneObjectList::addObject(SceneObject &&object, SceneObjectHandle handle) {
+	// The free slots are left as is, retain() and setFreeSlots() rebuild them once all the objects are added
+	u32 slot = handle.index;
+	while (m_storage.size() <= slot) {
+		m_storage.emplace_back();
+		m_slots.emplace_back();
+	}
+
+	if (m_storage[slot].m_handle.isValid())
+		removeAt(m_slots[slot].position);
+
+	m_slots[slot].generation = handle.generation;
+
+	m_storage[slot] = std::move(object);
+
+	SceneObject &newObject = m_storage[slot];
+	newObject.m_handle = handle;
+
+	m_slots[slot].position = static_cast<u32>(m_objects.size());
+	m_objects.emplace_back(&newObject);
+
+	addToIndex(m_nameIndex, newObject.name(), slot, &Slot::namePosition);
+	addToIndex(m_typeIndex, newObject.type(), slot, &Slot::typePosition);
+
+	if (m_scene)
+		m_scene->registerObject(newObject, m_parent);
+
+	return newObject;
+}
+
+void SceneObjectList::retain(const std::vector<SceneObject *> &objects) {
+	std::vector<bool> isRetained(m_storage.size());
+	for (SceneObject *object : objects)
+		isRetained[object->m_handle.index] = true;
+
+	for (SceneObject *object : m_objects)
+		if (object && !isRetained[object->m_handle.index])
+			release(*object);
+
+	m_objects = objects;
+	m_holeCount = 0;
+	for (size_t i = 0 ; i < m_objects.size() ; ++i)
+		m_slots[m_objects[i]->m_handle.index].position = static_cast<u32>(i);
+
+	m_freeSlots.clear();
+	for (u32 slot = 0 ; slot < m_storage.size() ; ++slot)
+		if (!isRetained[slot])
+			m_freeSlots.emplace_back(slot);
+}
+
+void SceneObjectList::setFreeSlots(u32 slotCount, const std::vector<SceneObjectHandle> &freeSlots) {
+	// Slots past the count are free, since they aren't used by the retained objects
+	m_storage.resize(slotCount);
+	m_slots.resize(slotCount);
+
+	m_freeSlots.clear();
+	for (SceneObjectHandle handle : freeSlots) {
+		m_slots[handle.index].generation = handle.generation;
+		m_freeSlots.emplace_back(handle.index);
+	}
+}
+
+void SceneObjectList::rename(SceneObject &object, const std::string &name, const std::string &type) {
+	u32 slot = object.m_handle.index;
+
+	if (object.m_name != name) {
+		removeFromIndex(m_nameIndex, object.m_name, slot, &Slot::namePosition);
+		object.m_name = name;
+		addToIndex(m_nameIndex, object.m_name, slot, &Slot::namePosition);
+	}
+
+	if (object.m_type != type) {
+		removeFromIndex(m_typeIndex, object.m_type, slot, &Slot::typePosition);
+		object.m_type = type;
+		addToIndex(m_typeIndex, object.m_type, slot, &Slot::typePosition);
+	}
+}
+
+} // namespace gk
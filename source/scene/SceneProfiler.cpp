@@ -0,0 +1,123 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+
+#ifdef __GNUG__
+#include <cxxabi.h>
+#endif
+
+#include "gk/core/Debug.hpp"
+#include "gk/scene/SceneProfiler.hpp"
+
+namespace gk {
+
+static std::string typeName(const std::type_info &type) {
+#ifdef __GNUG__
+	int status = 0;
+	std::unique_ptr<char, void (*)(void *)> name{abi::__cxa_demangle(type.name(), nullptr, nullptr, &status), std::free};
+	if (status == 0 && name)
+		return name.get();
+#endif
+	return type.name();
+}
+
+void SceneProfiler::addSample(const void *system, const std::type_info &type, Clock::duration duration, u64 objectCount) {
+	auto it = m_systemIndices.find(system);
+	if (it == m_systemIndices.end()) {
+		it = m_systemIndices.emplace(system, m_systems.size()).first;
+		m_systems.emplace_back();
+		m_systems.back().name = typeName(type);
+	}
+
+	System &data = m_systems[it->second];
+	data.lastTime = std::chrono::duration<float, std::micro>(duration).count();
+	data.objectCount = objectCount;
+
+	if (data.samples.size() < maxSampleCount)
+		data.samples.emplace_back(data.lastTime);
+	else
+		data.samples[data.nextSample] = data.lastTime;
+
+	data.nextSample = (data.nextSample + 1) % maxSampleCount;
+}
+
+void SceneProfiler::endTick() {
+	if (m_logInterval && ++m_tickCount >= m_logInterval) {
+		m_tickCount = 0;
+		log();
+	}
+}
+
+std::vector<SceneProfiler::Stats> SceneProfiler::stats() const {
+	std::vector<Stats> result;
+	std::vector<float> samples;
+	for (const System &system : m_systems) {
+		Stats stats;
+		stats.name = system.name;
+		stats.sampleCount = static_cast<u32>(system.samples.size());
+		stats.objectCount = system.objectCount;
+		stats.lastTime = system.lastTime;
+
+		if (!system.samples.empty()) {
+			samples = system.samples;
+			std::sort(samples.begin(), samples.end());
+
+			float sum = 0.f;
+			for (float sample : samples)
+				sum += sample;
+
+			stats.minTime = samples.front();
+			stats.averageTime = sum / static_cast<float>(samples.size());
+			stats.p99Time = samples[std::min(samples.size() - 1, samples.size() * 99 / 100)];
+		}
+
+		result.emplace_back(std::move(stats));
+	}
+
+	return result;
+}
+
+void SceneProfiler::log() const {
+	gkInfo() << "=== Scene timings (us): min / avg / p99 / last, objects ===";
+
+	char line[64];
+	for (const Stats &stats : this->stats()) {
+		std::snprintf(line, sizeof(line), "%9.1f / %9.1f / %9.1f / %9.1f", stats.minTime, stats.averageTime, stats.p99Time, stats.lastTime);
+		gkInfo() << line << stats.objectCount << stats.name;
+	}
+}
+
+void SceneProfiler::clear() {
+	m_systems.clear();
+	m_systemIndices.clear();
+	m_tickCount = 0;
+}
+
+} // namespace gk
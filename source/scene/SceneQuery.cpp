@@ -0,0 +1,90 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#include <algorithm>
+
+#include "gk/scene/SceneObject.hpp"
+#include "gk/scene/SceneQuery.hpp"
+
+namespace gk {
+
+void SceneQuery::add(SceneObject &object) {
+	if (m_indices.emplace(&object, m_objects.size()).second) {
+		if (object.m_insertionIndex < m_lastInsertionIndex)
+			m_isSortNeeded = true;
+		else
+			m_lastInsertionIndex = object.m_insertionIndex;
+
+		m_objects.emplace_back(&object);
+
+		if (m_isTrackingAddedObjects)
+			m_addedObjects.emplace_back(&object);
+
+		++m_version;
+	}
+}
+
+void SceneQuery::remove(const SceneObject &object) {
+	auto it = m_indices.find(&object);
+	if (it != m_indices.end()) {
+		m_objects[it->second] = nullptr;
+		m_indices.erase(it);
+
+		++m_holeCount;
+		++m_version;
+	}
+}
+
+void SceneQuery::compact() {
+	size_t size = 0;
+	for (size_t i = 0 ; i < m_objects.size() ; ++i) {
+		if (m_objects[i]) {
+			if (i != size) {
+				m_indices[m_objects[i]] = size;
+				m_objects[size] = m_objects[i];
+			}
+
+			++size;
+		}
+	}
+
+	m_objects.resize(size);
+	m_holeCount = 0;
+
+	if (m_isSortNeeded) {
+		std::sort(m_objects.begin(), m_objects.end(), [] (const SceneObject *object1, const SceneObject *object2) {
+			return object1->m_insertionIndex < object2->m_insertionIndex;
+		});
+
+		for (size_t i = 0 ; i < m_objects.size() ; ++i)
+			m_indices[m_objects[i]] = i;
+
+		m_lastInsertionIndex = m_objects.empty() ? 0 : m_objects.back()->m_insertionIndex;
+		m_isSortNeeded = false;
+	}
+}
+
+} // namespace gk
@@ -0,0 +1,267 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#include "gk/scene/Scene.hpp"
+#include "gk/scene/SceneSnapshot.hpp"
+
+namespace gk {
+
+static const u32 snapshotMagic = 0x53534b47; // "GKSS"
+
+// Function-local static, types can be registered during static initialization
+std::vector<SceneSnapshot::ComponentInfo> &SceneSnapshot::registeredComponents() {
+	static std::vector<SceneSnapshot::ComponentInfo> components;
+	return components;
+}
+
+void SceneSnapshot::save(const SceneObjectList &objects) {
+	m_data.clear();
+
+	SnapshotWriter writer{m_data};
+	writer.write(snapshotMagic);
+
+	// Restored objects get back their insertion index, so they're still drawn in the same order
+	writer.write(objects.m_scene ? objects.m_scene->m_nextInsertionIndex : u64(0));
+
+	saveList(objects, writer);
+}
+
+void SceneSnapshot::restore(SceneObjectList &objects) const {
+	SnapshotReader reader{m_data};
+
+	u32 magic = 0;
+	reader.read(magic);
+	if (magic != snapshotMagic)
+		throw EXCEPTION("Invalid scene snapshot");
+
+	u64 nextInsertionIndex = 0;
+	reader.read(nextInsertionIndex);
+
+	// The queries are sorted again even if the restore fails, since some objects may have a new index
+	try {
+		restoreList(objects, reader);
+	}
+	catch (...) {
+		if (objects.m_scene)
+			objects.m_scene->restoreInsertionIndices(nextInsertionIndex);
+
+		throw;
+	}
+
+	if (objects.m_scene)
+		objects.m_scene->restoreInsertionIndices(nextInsertionIndex);
+}
+
+void SceneSnapshot::registerComponent(const ComponentInfo &info) {
+	auto &components = registeredComponents();
+	for (const ComponentInfo &it : components)
+		if (it.typeID == info.typeID)
+			return;
+
+	components.emplace_back(info);
+}
+
+void SceneSnapshot::saveList(const SceneObjectList &objects, SnapshotWriter &writer) {
+	const auto &components = registeredComponents();
+
+	// The slots are saved too, so restoring keeps the handles
+	writer.write(static_cast<u32>(objects.m_slots.size()));
+
+	// Slots of the destroyed objects are freed after the free ones, as by removeDestroyedObjects()
+	size_t freeCountOffset = writer.size();
+	u32 freeCount = 0;
+	writer.write(freeCount);
+
+	for (u32 slot : objects.m_freeSlots) {
+		writer.write(slot);
+		writer.write(objects.m_slots[slot].generation);
+		++freeCount;
+	}
+
+	for (const SceneObject &object : objects) {
+		if (object.isDestroyed()) {
+			writer.write(object.handle().index);
+			writer.write(object.handle().generation + 1);
+			++freeCount;
+		}
+	}
+
+	writer.patch(freeCountOffset, freeCount);
+
+	size_t countOffset = writer.size();
+	u32 count = 0;
+	writer.write(count);
+
+	for (const SceneObject &object : objects) {
+		if (object.isDestroyed())
+			continue;
+
+		writer.write(object.handle().index);
+		writer.write(object.handle().generation);
+		writer.write(object.name());
+		writer.write(object.type());
+		writer.write(object.m_insertionIndex);
+
+		size_t componentCountOffset = writer.size();
+		u16 componentCount = 0;
+		writer.write(componentCount);
+
+		for (u16 key = 0 ; key < components.size() ; ++key) {
+			const ComponentInfo &info = components[key];
+			if (!object.m_signature[info.typeID])
+				continue;
+
+			// The size allows programs that don't know the type to skip it
+			writer.write(key);
+			size_t sizeOffset = writer.size();
+			writer.write(u32(0));
+
+			info.save(object.data(info.typeID), writer);
+
+			writer.patch(sizeOffset, static_cast<u32>(writer.size() - sizeOffset - sizeof(u32)));
+			++componentCount;
+		}
+
+		writer.patch(componentCountOffset, componentCount);
+
+		auto *children = object.tryGet<SceneObjectList>();
+		writer.write(u8(children != nullptr));
+		if (children)
+			saveList(*children, writer);
+
+		++count;
+	}
+
+	writer.patch(countOffset, count);
+}
+
+void SceneSnapshot::restoreList(SceneObjectList &objects, SnapshotReader &reader) {
+	const auto &components = registeredComponents();
+
+	u32 slotCount = 0;
+	reader.read(slotCount);
+
+	u32 freeCount = 0;
+	reader.read(freeCount);
+
+	std::vector<SceneObjectHandle> freeSlots;
+	for (u32 i = 0 ; i < freeCount ; ++i) {
+		SceneObjectHandle handle;
+		reader.read(handle.index);
+		reader.read(handle.generation);
+		if (handle.index >= slotCount)
+			throw EXCEPTION("Invalid scene snapshot slot:", handle.index, "| Slot count:", slotCount);
+
+		freeSlots.emplace_back(handle);
+	}
+
+	u32 count = 0;
+	reader.read(count);
+
+	// Objects are matched by handle, so an object removed since the snapshot was
+	// saved is recreated in its slot instead of reusing another one
+	std::vector<SceneObject *> restoredObjects;
+	try {
+		std::string name, type;
+		for (u32 i = 0 ; i < count ; ++i) {
+			SceneObjectHandle handle;
+			reader.read(handle.index);
+			reader.read(handle.generation);
+			if (handle.index >= slotCount)
+				throw EXCEPTION("Invalid scene snapshot slot:", handle.index, "| Slot count:", slotCount);
+
+			reader.read(name);
+			reader.read(type);
+
+			u64 insertionIndex = 0;
+			reader.read(insertionIndex);
+
+			SceneObject *object = objects.get(handle);
+			if (object) {
+				object->m_isDestroyed = false;
+
+				if (object->name() != name || object->type() != type)
+					objects.rename(*object, name, type);
+			}
+			else {
+				object = &objects.addObject(SceneObject{name, type}, handle);
+			}
+
+			object->m_insertionIndex = insertionIndex;
+
+			restoredObjects.emplace_back(object);
+
+			ComponentSignature restoredComponents;
+
+			u16 componentCount = 0;
+			reader.read(componentCount);
+			for (u16 j = 0 ; j < componentCount ; ++j) {
+				u16 key = 0;
+				u32 size = 0;
+				reader.read(key);
+				reader.read(size);
+
+				if (key >= components.size()) {
+					reader.skip(size);
+					continue;
+				}
+
+				const ComponentInfo &info = components[key];
+
+				size_t position = reader.position();
+				info.load(*object, reader);
+				if (reader.position() - position != size)
+					throw EXCEPTION("Scene snapshot component of type", ComponentType::name(info.typeID), "read", reader.position() - position, "bytes instead of", size);
+
+				restoredComponents.set(info.typeID);
+			}
+
+			for (const ComponentInfo &info : components)
+				if (object->m_signature[info.typeID] && !restoredComponents[info.typeID])
+					info.remove(*object);
+
+			u8 hasChildren = 0;
+			reader.read(hasChildren);
+			if (hasChildren) {
+				auto *children = object->tryGet<SceneObjectList>();
+				restoreList(children ? *children : object->set<SceneObjectList>(), reader);
+			}
+			else if (object->has<SceneObjectList>()) {
+				object->remove<SceneObjectList>();
+			}
+		}
+	}
+	catch (...) {
+		// Leaves the list in a valid state
+		objects.retain(restoredObjects);
+		throw;
+	}
+
+	objects.retain(restoredObjects);
+	objects.setFreeSlots(slotCount, freeSlots);
+}
+
+} // namespace gk
@@ -0,0 +1,198 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#include <algorithm>
+#include <cmath>
+
+#include "gk/scene/component/HitboxComponent.hpp"
+#include "gk/scene/SortAndSweepCollisionHelper.hpp"
+
+namespace gk {
+
+static constexpr u32 noIndex = ~0u;
+
+static bool contains(const FloatRect &rect1, const FloatRect &rect2) {
+	return rect2.x >= rect1.x && rect2.y >= rect1.y
+		&& rect2.x + rect2.sizeX <= rect1.x + rect1.sizeX
+		&& rect2.y + rect2.sizeY <= rect1.y + rect1.sizeY;
+}
+
+void SortAndSweepCollisionHelper::rebuild(SceneObjectList &objects) {
+	++m_stamp;
+
+	size_t addedEndpoints = 0;
+	forEachHitbox(objects, [&] (SceneObject &object, SceneObject *parent, const FloatRect &rect) {
+		auto it = m_entryIndices.emplace(&object, 0);
+		if (it.second) {
+			if (m_freeEntries.empty()) {
+				it.first->second = static_cast<u32>(m_entries.size());
+				m_entries.emplace_back();
+			}
+			else {
+				it.first->second = m_freeEntries.back();
+				m_freeEntries.pop_back();
+			}
+
+			m_endpoints.push_back({0.f, it.first->second});
+			m_endpoints.push_back({0.f, it.first->second | endBit});
+			addedEndpoints += 2;
+		}
+
+		Entry &entry = m_entries[it.first->second];
+		entry.object = &object;
+		entry.parent = parent;
+		entry.rect = rect;
+		entry.stamp = m_stamp;
+		entry.isStatic = object.get<HitboxComponent>().isStatic();
+	});
+
+	// Objects that weren't found are gone or don't have a hitbox anymore
+	bool hasRemovedEntries = false;
+	for (u32 i = 0 ; i < m_entries.size() ; ++i) {
+		Entry &entry = m_entries[i];
+		if (entry.object && entry.stamp != m_stamp) {
+			m_entryIndices.erase(entry.object);
+			m_freeEntries.emplace_back(i);
+
+			entry.object = nullptr;
+			hasRemovedEntries = true;
+		}
+	}
+
+	if (hasRemovedEntries) {
+		m_endpoints.erase(std::remove_if(m_endpoints.begin(), m_endpoints.end(), [this] (const Endpoint &endpoint) {
+			return m_entries[endpoint.entry & ~endBit].object == nullptr;
+		}), m_endpoints.end());
+	}
+
+	for (Endpoint &endpoint : m_endpoints) {
+		const FloatRect &rect = m_entries[endpoint.entry & ~endBit].rect;
+		endpoint.value = (endpoint.entry & endBit) ? rect.x + rect.sizeX : rect.x;
+
+		// NaN would break the ordering
+		if (std::isnan(endpoint.value))
+			endpoint.value = 0.f;
+	}
+
+	// The array is almost sorted already, unless a lot of objects were just added
+	if (addedEndpoints * 8 > m_endpoints.size()) {
+		std::sort(m_endpoints.begin(), m_endpoints.end());
+	}
+	else {
+		for (size_t i = 1 ; i < m_endpoints.size() ; ++i) {
+			Endpoint endpoint = m_endpoints[i];
+
+			size_t j = i;
+			for ( ; j > 0 && endpoint < m_endpoints[j - 1] ; --j)
+				m_endpoints[j] = m_endpoints[j - 1];
+
+			m_endpoints[j] = endpoint;
+		}
+	}
+
+	sweep();
+}
+
+void SortAndSweepCollisionHelper::findCandidates(const SceneObject &object, const FloatRect &rect, std::vector<Candidate> &candidates) {
+	// The neighbours are only complete if the hitbox is still in the one of the last rebuild,
+	// which isn't the case either if the object was added or made dynamic since
+	auto it = m_entryIndices.find(&object);
+	if (it == m_entryIndices.end() || !contains(m_entries[it->second].rect, rect)
+	 || m_entries[it->second].isStatic != object.get<HitboxComponent>().isStatic()) {
+		for (const Entry &entry : m_entries)
+			if (entry.object && entry.rect.intersects(rect))
+				candidates.push_back({entry.object, entry.parent});
+
+		return;
+	}
+
+	for (u32 i = m_neighbourStart[it->second] ; i < m_neighbourStart[it->second + 1] ; ++i) {
+		const Entry &entry = m_entries[m_neighbours[i]];
+		if (entry.rect.intersects(rect))
+			candidates.push_back({entry.object, entry.parent});
+	}
+}
+
+void SortAndSweepCollisionHelper::sweep() {
+	for (Entry &entry : m_entries)
+		entry.activeIndex = noIndex;
+
+	m_active.clear();
+	m_activeStatic.clear();
+	m_overlaps.clear();
+
+	auto addOverlaps = [this] (u32 index, const std::vector<u32> &active) {
+		const FloatRect &entryRect = m_entries[index].rect;
+		for (u32 other : active) {
+			const FloatRect &rect = m_entries[other].rect;
+			if (std::max(rect.y, entryRect.y) <= std::min(rect.y + rect.sizeY, entryRect.y + entryRect.sizeY)) {
+				m_overlaps.emplace_back(index, other);
+				m_overlaps.emplace_back(other, index);
+			}
+		}
+	};
+
+	for (const Endpoint &endpoint : m_endpoints) {
+		u32 index = endpoint.entry & ~endBit;
+		Entry &entry = m_entries[index];
+		std::vector<u32> &active = entry.isStatic ? m_activeStatic : m_active;
+
+		if (endpoint.entry & endBit) {
+			if (entry.activeIndex != noIndex) {
+				u32 last = active.back();
+				active[entry.activeIndex] = last;
+				m_entries[last].activeIndex = entry.activeIndex;
+				active.pop_back();
+
+				entry.activeIndex = noIndex;
+			}
+		}
+		else {
+			// Every active hitbox overlaps this one on the x axis, but static ones never collide together
+			addOverlaps(index, m_active);
+			if (!entry.isStatic)
+				addOverlaps(index, m_activeStatic);
+
+			entry.activeIndex = static_cast<u32>(active.size());
+			active.emplace_back(index);
+		}
+	}
+
+	m_neighbourStart.assign(m_entries.size() + 1, 0);
+	for (auto &it : m_overlaps)
+		++m_neighbourStart[it.first + 1];
+
+	for (size_t i = 0 ; i < m_entries.size() ; ++i)
+		m_neighbourStart[i + 1] += m_neighbourStart[i];
+
+	m_neighbours.resize(m_overlaps.size());
+	m_neighbourCursor.assign(m_neighbourStart.begin(), m_neighbourStart.end() - 1);
+
+	for (auto &it : m_overlaps)
+		m_neighbours[m_neighbourCursor[it.first]++] = it.second;
+}
+
+} // namespace gk
@@ -0,0 +1,186 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#include <algorithm>
+#include <cmath>
+
+#include "gk/core/Exception.hpp"
+#include "gk/scene/component/HitboxComponent.hpp"
+#include "gk/scene/SpatialHashCollisionHelper.hpp"
+
+namespace gk {
+
+// Entries covering more cells than this are tested against every object instead
+static const s32 maxCellsPerEntry = 64;
+
+SpatialHashCollisionHelper::SpatialHashCollisionHelper(float cellSize, float margin)
+	: BroadphaseCollisionHelper(margin), m_cellSize(cellSize)
+{
+	if (!(cellSize > 0.f))
+		throw EXCEPTION("Invalid spatial hash cell size:", cellSize);
+}
+
+void SpatialHashCollisionHelper::rebuild(SceneObjectList &objects) {
+	m_grid.entries.clear();
+
+	// The static objects are visited in the same order as in the last rebuild,
+	// so any change shows up as an entry that doesn't match anymore
+	u32 staticCount = 0;
+	bool isStaticGridDirty = false;
+	forEachHitbox(objects, [&] (SceneObject &object, SceneObject *parent, const FloatRect &rect) {
+		if (object.get<HitboxComponent>().isStatic()) {
+			if (!isStaticGridDirty) {
+				const Entry *entry = staticCount < m_staticGrid.entries.size() ? &m_staticGrid.entries[staticCount] : nullptr;
+				isStaticGridDirty = !entry || entry->object != &object || entry->parent != parent || entry->rect != rect;
+			}
+
+			++staticCount;
+		}
+		else
+			m_grid.entries.push_back({&object, parent, rect,
+				cellCoord(rect.x), cellCoord(rect.y),
+				cellCoord(rect.x + rect.sizeX), cellCoord(rect.y + rect.sizeY), 0});
+	});
+
+	if (isStaticGridDirty || staticCount != m_staticGrid.entries.size()) {
+		m_staticGrid.entries.clear();
+
+		forEachHitbox(objects, [this] (SceneObject &object, SceneObject *parent, const FloatRect &rect) {
+			if (object.get<HitboxComponent>().isStatic())
+				m_staticGrid.entries.push_back({&object, parent, rect,
+					cellCoord(rect.x), cellCoord(rect.y),
+					cellCoord(rect.x + rect.sizeX), cellCoord(rect.y + rect.sizeY), 0});
+		});
+
+		build(m_staticGrid);
+	}
+
+	build(m_grid);
+}
+
+void SpatialHashCollisionHelper::findCandidates(const SceneObject &, const FloatRect &rect, std::vector<Candidate> &candidates) {
+	if (++m_stamp == 0) {
+		for (Entry &entry : m_grid.entries)
+			entry.stamp = 0;
+
+		for (Entry &entry : m_staticGrid.entries)
+			entry.stamp = 0;
+
+		m_stamp = 1;
+	}
+
+	findCandidates(m_grid, rect, candidates);
+	findCandidates(m_staticGrid, rect, candidates);
+}
+
+void SpatialHashCollisionHelper::build(Grid &grid) {
+	grid.largeEntries.clear();
+
+	for (u32 i = 0 ; i < grid.entries.size() ; ++i) {
+		Entry &entry = grid.entries[i];
+
+		s64 cellCount = (s64(entry.x2) - entry.x1 + 1) * (s64(entry.y2) - entry.y1 + 1);
+		if (cellCount > maxCellsPerEntry) {
+			grid.largeEntries.emplace_back(i);
+
+			// Empty range, so the entry isn't stored in the grid
+			entry.x2 = entry.x1 - 1;
+		}
+	}
+
+	u32 bucketCount = 16;
+	while (bucketCount < grid.entries.size() * 2)
+		bucketCount *= 2;
+
+	grid.bucketMask = bucketCount - 1;
+	grid.bucketStart.assign(bucketCount + 1, 0);
+
+	// Entries are sorted by bucket, so each bucket is a contiguous range of bucketEntries
+	for (const Entry &entry : grid.entries)
+		for (s32 y = entry.y1 ; y <= entry.y2 ; ++y)
+			for (s32 x = entry.x1 ; x <= entry.x2 ; ++x)
+				++grid.bucketStart[bucket(grid, x, y) + 1];
+
+	for (u32 i = 0 ; i < bucketCount ; ++i)
+		grid.bucketStart[i + 1] += grid.bucketStart[i];
+
+	grid.bucketEntries.resize(grid.bucketStart[bucketCount]);
+	grid.bucketCursor.assign(grid.bucketStart.begin(), grid.bucketStart.end() - 1);
+
+	for (u32 i = 0 ; i < grid.entries.size() ; ++i) {
+		const Entry &entry = grid.entries[i];
+		for (s32 y = entry.y1 ; y <= entry.y2 ; ++y)
+			for (s32 x = entry.x1 ; x <= entry.x2 ; ++x)
+				grid.bucketEntries[grid.bucketCursor[bucket(grid, x, y)]++] = i;
+	}
+}
+
+void SpatialHashCollisionHelper::findCandidates(Grid &grid, const FloatRect &rect, std::vector<Candidate> &candidates) {
+	s32 x1 = cellCoord(rect.x);
+	s32 y1 = cellCoord(rect.y);
+	s32 x2 = cellCoord(rect.x + rect.sizeX);
+	s32 y2 = cellCoord(rect.y + rect.sizeY);
+
+	// Testing every entry is faster than looking up more cells than there are buckets
+	if ((s64(x2) - x1 + 1) * (s64(y2) - y1 + 1) > grid.bucketMask) {
+		for (const Entry &entry : grid.entries)
+			if (entry.rect.intersects(rect))
+				candidates.push_back({entry.object, entry.parent});
+
+		return;
+	}
+
+	for (u32 i : grid.largeEntries)
+		if (grid.entries[i].rect.intersects(rect))
+			candidates.push_back({grid.entries[i].object, grid.entries[i].parent});
+
+	for (s32 y = y1 ; y <= y2 ; ++y) {
+		for (s32 x = x1 ; x <= x2 ; ++x) {
+			u32 b = bucket(grid, x, y);
+			for (u32 i = grid.bucketStart[b] ; i < grid.bucketStart[b + 1] ; ++i) {
+				Entry &entry = grid.entries[grid.bucketEntries[i]];
+				if (entry.stamp != m_stamp) {
+					entry.stamp = m_stamp;
+
+					if (entry.rect.intersects(rect))
+						candidates.push_back({entry.object, entry.parent});
+				}
+			}
+		}
+	}
+}
+
+s32 SpatialHashCollisionHelper::cellCoord(float coord) const {
+	// Clamped to stay in the range of s32, even for infinite or NaN coordinates
+	float cell = std::floor(coord / m_cellSize);
+	return static_cast<s32>(std::max(-1e9f, std::min(cell, 1e9f)));
+}
+
+u32 SpatialHashCollisionHelper::bucket(const Grid &grid, s32 x, s32 y) const {
+	return ((static_cast<u32>(x) * 73856093u) ^ (static_cast<u32>(y) * 19349663u)) & grid.bucketMask;
+}
+
+} // namespace gk
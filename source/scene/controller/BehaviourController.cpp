@@ -26,13 +26,27 @@
  */
 #include "gk/scene/component/BehaviourComponent.hpp"
 #include "gk/scene/component/LifetimeComponent.hpp"
+#include "gk/scene/component/MovementComponent.hpp"
+#include "gk/scene/component/PositionComponent.hpp"
+#include "gk/scene/component/UpdateRateComponent.hpp"
 #include "gk/scene/controller/BehaviourController.hpp"
 
 namespace gk {
 
+BehaviourController::BehaviourController() {
+	m_filter.all = componentSignature<BehaviourComponent>();
+
+	// Behaviours usually steer their object, the other components
+	// they access must be declared by the game
+	reads<LifetimeComponent, UpdateRateComponent>().writes<BehaviourComponent, MovementComponent, PositionComponent>();
+}
+
 void BehaviourController::update(SceneObject &object) {
-	if(object.has<BehaviourComponent>() && (!object.has<LifetimeComponent>() || !object.get<LifetimeComponent>().dead(object))) {
-		object.get<BehaviourComponent>().update(object);
+	auto *behaviour = object.tryGet<BehaviourComponent>();
+	auto *lifetime = object.tryGet<LifetimeComponent>();
+	auto *rate = object.tryGet<UpdateRateComponent>();
+	if(behaviour && (!lifetime || !lifetime->isDead()) && (!rate || rate->isDue())) {
+		behaviour->update(object);
 	}
 }
 
@@ -24,35 +24,153 @@
  *
  * =====================================================================================
  */
+#include "gk/core/GameClock.hpp"
 #include "gk/scene/component/LifetimeComponent.hpp"
 #include "gk/scene/controller/LifetimeController.hpp"
+#include "gk/scene/Scene.hpp"
 
 namespace gk {
 
+// Objects are only destroyed once their children are dead
+static bool areChildrenDead(SceneObject &object) {
+	if (auto *children = object.tryGet<SceneObjectList>()) {
+		for (SceneObject &child : *children) {
+			auto *lifetime = child.tryGet<LifetimeComponent>();
+			if (lifetime && !lifetime->isDead())
+				return false;
+		}
+	}
+
+	return true;
+}
+
+LifetimeController::LifetimeController() {
+	writes<LifetimeComponent>();
+}
+
 void LifetimeController::update(SceneObjectList &objects) {
-	for(size_t i = 0 ; i < objects.size() ; i++) {
-		if (objects[i].has<SceneObjectList>())
-			update(objects[i].get<SceneObjectList>());
-
-		if(objects[i].has<LifetimeComponent>()) {
-			auto &lifetimeComponent = objects[i].get<LifetimeComponent>();
-			if (lifetimeComponent.dead(objects[i]) && lifetimeComponent.areClientsNotified()) {
-				bool canDelete = true;
-				if (objects[i].has<SceneObjectList>()) {
-					for (SceneObject &object : objects[i].get<SceneObjectList>()) {
-						if (object.has<LifetimeComponent>() && !object.get<LifetimeComponent>().dead(object)) {
-							canDelete = false;
-							break;
-						}
-					}
+	// The clock is only read once per tick
+	u32 time = GameClock::getInstance().getTicks();
+
+	if (Scene *scene = objects.scene()) {
+		expireObjects(*scene, time);
+		updateObjects(*scene);
+	}
+	else {
+		SceneCommandBuffer commands;
+		updateObjects(objects, commands, time);
+		commands.flush(objects);
+	}
+}
+
+void LifetimeController::expireObjects(Scene &scene, u32 time) {
+	SceneQuery &query = scene.query<LifetimeComponent>();
+	if (&scene != m_scene) {
+		m_expiries.clear();
+		m_checkedObjects.clear();
+		m_scene = &scene;
+
+		// The components linked to the previous scene are seen as new
+		m_checkList.reset(new LifetimeCheckList);
+
+		// Only the objects added to the query from now on are reported
+		query.setAddedObjectsTracked(true);
+		query.forEach([&] (SceneObject &object) {
+			m_checkedObjects.emplace_back(&object);
+		});
+	}
+
+	m_expiries.advance(time, [&] (const Expiry &expiry) {
+		// The object may have been removed, and its address reused by another one
+		if (query.contains(*expiry.object) && expiry.object->handle().generation == expiry.generation) {
+			auto &lifetimeComponent = expiry.object->get<LifetimeComponent>();
+			if (lifetimeComponent.m_deathDate == expiry.deathDate)
+				lifetimeComponent.kill();
+		}
+	});
+}
+
+void LifetimeController::updateObjects(Scene &scene) {
+	SceneQuery &query = scene.query<LifetimeComponent>();
+
+	m_objects.swap(m_checkedObjects);
+	m_checkedObjects.clear();
+
+	query.takeAddedObjects(m_newObjects);
+	m_objects.insert(m_objects.end(), m_newObjects.begin(), m_newObjects.end());
+
+	m_checkList->take(m_newObjects);
+	m_objects.insert(m_objects.end(), m_newObjects.begin(), m_newObjects.end());
+
+	m_deadObjects.clear();
+	++m_tick;
+
+	for (SceneObject *object : m_objects) {
+		// The object may have been removed since it was added to the lists
+		if (!query.contains(*object))
+			continue;
+
+		auto &lifetimeComponent = object->get<LifetimeComponent>();
+
+		// Objects can be in several lists
+		LifetimeComponent::Link &link = lifetimeComponent.m_link;
+		if (link.checkTick == m_tick)
+			continue;
+
+		link.checkTick = m_tick;
+
+		if (link.checkList != m_checkList) {
+			link.checkList = m_checkList;
+			link.object = object;
+
+			if (lifetimeComponent.m_lifetime != 0 && !lifetimeComponent.m_isKilled) {
+				lifetimeComponent.m_deathDate = lifetimeComponent.deathDate();
+				lifetimeComponent.m_isScheduled = true;
+
+				m_expiries.schedule(lifetimeComponent.m_deathDate, {object, object->handle().generation, lifetimeComponent.m_deathDate});
+			}
+		}
+
+		// The others are killed by the timing wheel
+		if (lifetimeComponent.m_isKilled || lifetimeComponent.m_deathChecker) {
+			lifetimeComponent.updateDeathState(*object);
+
+			if (lifetimeComponent.isDead() && lifetimeComponent.areClientsNotified())
+				m_deadObjects.emplace_back(object);
+		}
+
+		if (lifetimeComponent.m_deathChecker || lifetimeComponent.isDead())
+			m_checkedObjects.emplace_back(object);
+	}
+
+	// Checked after the loop, since the children may come after their parent in the query
+	for (SceneObject *object : m_deadObjects)
+		if (areChildrenDead(*object))
+			scene.commands().destroy(*object);
+}
+
+void LifetimeController::updateObjects(SceneObjectList &objects, SceneCommandBuffer &commands, u32 time) {
+	for (SceneObject &object : objects) {
+		if (auto *children = object.tryGet<SceneObjectList>())
+			updateObjects(*children, commands, time);
+
+		if(auto *lifetimeComponent = object.tryGet<LifetimeComponent>()) {
+			if (lifetimeComponent->m_lifetime != 0 && !lifetimeComponent->m_isKilled) {
+				if (!lifetimeComponent->m_isScheduled) {
+					lifetimeComponent->m_deathDate = lifetimeComponent->deathDate();
+					lifetimeComponent->m_isScheduled = true;
 				}
 
-				if (canDelete)
-					objects.remove(i--);
+				if (static_cast<s32>(time - lifetimeComponent->m_deathDate) >= 0)
+					lifetimeComponent->kill();
 			}
+
+			lifetimeComponent->updateDeathState(object);
+
+			if (lifetimeComponent->isDead() && lifetimeComponent->areClientsNotified() && areChildrenDead(object))
+				commands.destroy(object);
 		}
 	}
 }
 
 } // namespace gk
-
@@ -24,38 +24,178 @@
  *
  * =====================================================================================
  */
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include "gk/scene/controller/MovementController.hpp"
 
 #include "gk/scene/component/CollisionComponent.hpp"
+#include "gk/scene/component/HitboxComponent.hpp"
 #include "gk/scene/component/MovementComponent.hpp"
 #include "gk/scene/component/PositionComponent.hpp"
+#include "gk/scene/component/UpdateRateComponent.hpp"
 
 namespace gk {
 
+// Objects per batch, few enough for their components to still be in cache when they're written
+static const size_t batchSize = 256;
+
+// Returns false if the object is asleep, in which case it doesn't move
+static bool updateSleepState(MovementComponent &movement) {
+	if(movement.v.x || movement.v.y) {
+		movement.wakeUp();
+	}
+	else if(movement.sleepDelay && !movement.isSleeping && ++movement.idleTicks >= movement.sleepDelay) {
+		movement.isSleeping = true;
+	}
+
+	return !movement.isSleeping;
+}
+
+// Same operations as the per-object path, so the results are identical
+static void integrateBatch(size_t count, float *x, float *y, const float *vx, const float *vy, const float *speed, u8 *isMoving) {
+	size_t i = 0;
+
+#if defined(__AVX__)
+	const __m256 zero = _mm256_setzero_ps();
+	for ( ; i + 8 <= count ; i += 8) {
+		__m256 s = _mm256_loadu_ps(speed + i);
+		__m256 dx = _mm256_loadu_ps(vx + i);
+		__m256 dy = _mm256_loadu_ps(vy + i);
+
+		_mm256_storeu_ps(x + i, _mm256_add_ps(_mm256_loadu_ps(x + i), _mm256_mul_ps(dx, s)));
+		_mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i), _mm256_mul_ps(dy, s)));
+
+		int mask = _mm256_movemask_ps(_mm256_or_ps(_mm256_cmp_ps(dx, zero, _CMP_NEQ_UQ), _mm256_cmp_ps(dy, zero, _CMP_NEQ_UQ)));
+		for (int j = 0 ; j < 8 ; ++j)
+			isMoving[i + size_t(j)] = u8((mask >> j) & 1);
+	}
+#endif
+
+#if defined(__SSE2__)
+	const __m128 zero4 = _mm_setzero_ps();
+	for ( ; i + 4 <= count ; i += 4) {
+		__m128 s = _mm_loadu_ps(speed + i);
+		__m128 dx = _mm_loadu_ps(vx + i);
+		__m128 dy = _mm_loadu_ps(vy + i);
+
+		_mm_storeu_ps(x + i, _mm_add_ps(_mm_loadu_ps(x + i), _mm_mul_ps(dx, s)));
+		_mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(dy, s)));
+
+		int mask = _mm_movemask_ps(_mm_or_ps(_mm_cmpneq_ps(dx, zero4), _mm_cmpneq_ps(dy, zero4)));
+		for (int j = 0 ; j < 4 ; ++j)
+			isMoving[i + size_t(j)] = u8((mask >> j) & 1);
+	}
+#endif
+
+	for ( ; i < count ; ++i) {
+		x[i] += vx[i] * speed[i];
+		y[i] += vy[i] * speed[i];
+		isMoving[i] = vx[i] || vy[i];
+	}
+}
+
+MovementController::MovementController() {
+	m_filter.any = componentSignature<MovementComponent, CollisionComponent>();
+
+	// Collision checks read the other objects, so it's not data-parallel.
+	// The other components accessed by the collision actions must be declared by the game.
+	reads<HitboxComponent, CollisionComponent, UpdateRateComponent>().writes<PositionComponent, MovementComponent>();
+}
+
 void MovementController::update(SceneObject &object) {
-	if(object.has<MovementComponent>()) {
-		auto &movement = object.get<MovementComponent>();
+	// Skipped objects integrate the elapsed ticks at their next update
+	auto *rate = object.tryGet<UpdateRateComponent>();
+	if (rate && !rate->isDue())
+		return;
 
-		if(movement.movements.size() != 0 && movement.movements.top()) {
-			movement.movements.top()->process(object);
+	u16 elapsedTicks = rate ? rate->elapsedTicks() : 1;
+
+	auto *movement = object.tryGet<MovementComponent>();
+	auto *collisionComponent = object.tryGet<CollisionComponent>();
+
+	bool hasMovement = movement && movement->movements.size() != 0 && movement->movements.top();
+
+	// The batch is shared by the objects, so it can't be used from several threads
+	if (movement && !hasMovement && !collisionComponent && m_isBatchingEnabled && !isDataParallel()) {
+		if (!updateSleepState(*movement))
+			return;
+
+		movement->isBlocked.x = false;
+		movement->isBlocked.y = false;
+
+		// The components are gathered while they're in cache, flush() only writes the results back
+		auto &position = object.get<PositionComponent>();
+		m_batch.movements.emplace_back(movement);
+		m_batch.positions.emplace_back(&position);
+		m_batch.x.emplace_back(position.x);
+		m_batch.y.emplace_back(position.y);
+		m_batch.vx.emplace_back(movement->v.x);
+		m_batch.vy.emplace_back(movement->v.y);
+		m_batch.speed.emplace_back(movement->speed * float(elapsedTicks));
+
+		if (m_batch.size() == batchSize)
+			flush();
+
+		return;
+	}
+
+	// The movement and the collision checks may read the position of the pending objects
+	flush();
+
+	if(movement) {
+		if(hasMovement) {
+			movement->movements.top()->process(object);
 		}
 
-		movement.isBlocked.x = false;
-		movement.isBlocked.y = false;
+		if(!updateSleepState(*movement))
+			return;
+
+		movement->isBlocked.x = false;
+		movement->isBlocked.y = false;
 	}
 
-	if(object.has<CollisionComponent>()) {
-		object.get<CollisionComponent>().checkCollisions(object);
+	auto *hitbox = object.tryGet<HitboxComponent>();
+	if(collisionComponent && !(hitbox && hitbox->isStatic())) {
+		collisionComponent->checkCollisions(object);
 	}
 
-	if(object.has<MovementComponent>()) {
-		auto &movement = object.get<MovementComponent>();
+	if(movement) {
+		movement->isMoving = movement->v.x || movement->v.y;
 
-		movement.isMoving = movement.v.x || movement.v.y;
+		object.get<PositionComponent>() += movement->v * (movement->speed * float(elapsedTicks));
+	}
+}
+
+void MovementController::flush() {
+	if (m_batch.size() == 0)
+		return;
+
+	m_batch.isMoving.resize(m_batch.size());
+
+	integrateBatch(m_batch.size(), m_batch.x.data(), m_batch.y.data(), m_batch.vx.data(), m_batch.vy.data(), m_batch.speed.data(), m_batch.isMoving.data());
 
-		object.get<PositionComponent>() += movement.v * movement.speed;
+	for (size_t i = 0 ; i < m_batch.size() ; ++i) {
+		m_batch.positions[i]->x = m_batch.x[i];
+		m_batch.positions[i]->y = m_batch.y[i];
+		m_batch.movements[i]->isMoving = m_batch.isMoving[i];
 	}
+
+	m_batch.clear();
 }
 
-} // namespace gk
+void MovementController::Batch::clear() {
+	movements.clear();
+	positions.clear();
 
+	x.clear();
+	y.clear();
+	vx.clear();
+	vy.clear();
+	speed.clear();
+}
+
+} // namespace gk
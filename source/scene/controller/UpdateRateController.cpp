@@ -0,0 +1,94 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#include <algorithm>
+#include <cmath>
+
+#include "gk/gl/View.hpp"
+#include "gk/scene/component/CollisionComponent.hpp"
+#include "gk/scene/component/PositionComponent.hpp"
+#include "gk/scene/component/UpdateRateComponent.hpp"
+#include "gk/scene/controller/UpdateRateController.hpp"
+
+namespace gk {
+
+UpdateRateController::UpdateRateController(float baseDistance, u8 maxLevel)
+	: m_baseDistance(baseDistance), m_maxLevel(std::min(maxLevel, UpdateRateComponent::maxLevel))
+{
+	m_filter.all = componentSignature<UpdateRateComponent>();
+
+	reads<PositionComponent>().writes<UpdateRateComponent>().setDataParallel(true);
+}
+
+void UpdateRateController::update(SceneObject &object) {
+	auto &rate = object.get<UpdateRateComponent>();
+	if (rate.m_isAutomatic) {
+		auto *position = object.tryGet<PositionComponent>();
+		rate.m_level = position ? levelAt(*position) : 0;
+	}
+
+	// Slot indices are dense, so they spread the objects of a level evenly across ticks
+	if (!rate.m_isScheduled) {
+		rate.m_isScheduled = true;
+		rate.m_phase = static_cast<u16>(object.handle().index);
+		rate.m_lastUpdate = m_tick - 1;
+	}
+
+	// Collisions are only checked along one tick of movement, so colliders are never throttled
+	u16 interval = object.has<CollisionComponent>() ? 1 : rate.interval();
+	rate.m_isDue = ((m_tick + rate.m_phase) & (interval - 1u)) == 0;
+	if (rate.m_isDue) {
+		rate.m_elapsedTicks = static_cast<u16>(std::min<u32>(m_tick - rate.m_lastUpdate, 0xffff));
+		rate.m_lastUpdate = m_tick;
+	}
+}
+
+u8 UpdateRateController::levelAt(const Vector2f &position) const {
+	if (!m_view && m_pointsOfInterest.empty())
+		return 0;
+
+	float distance = INFINITY;
+	if (m_view) {
+		// Distance to the visible rectangle, so objects on screen are always updated
+		float dx = std::max(std::abs(position.x - m_view->getCenter().x) - m_view->getSize().x / 2.f, 0.f);
+		float dy = std::max(std::abs(position.y - m_view->getCenter().y) - m_view->getSize().y / 2.f, 0.f);
+		distance = std::sqrt(dx * dx + dy * dy);
+	}
+
+	for (const Vector2f &point : m_pointsOfInterest) {
+		float dx = position.x - point.x;
+		float dy = position.y - point.y;
+		distance = std::min(distance, std::sqrt(dx * dx + dy * dy));
+	}
+
+	if (distance <= m_baseDistance)
+		return 0;
+
+	float level = std::floor(std::log2(distance / m_baseDistance)) + 1.f;
+	return static_cast<u8>(std::min(level, float(m_maxLevel)));
+}
+
+} // namespace gk
@@ -25,6 +25,7 @@
  * =====================================================================================
  */
 #include "gk/graphics/RectangleShape.hpp"
+#include "gk/scene/CollisionHelper.hpp"
 #include "gk/scene/component/HitboxComponent.hpp"
 #include "gk/scene/view/HitboxView.hpp"
 #include "gk/scene/component/LifetimeComponent.hpp"
@@ -32,16 +33,25 @@
 
 namespace gk {
 
+HitboxView::HitboxView() {
+	m_filter.all = componentSignature<HitboxComponent, PositionComponent>();
+}
+
+bool HitboxView::getBounds(const SceneObject &object, FloatRect &bounds) const {
+	return CollisionHelper::getHitboxRect(object, bounds, false);
+}
+
 void HitboxView::draw(const SceneObject &object, RenderTarget &target, RenderStates states) {
-	if (object.has<LifetimeComponent>() && object.get<LifetimeComponent>().dead(object))
+	auto *lifetime = object.tryGet<LifetimeComponent>();
+	if (lifetime && lifetime->isDead())
 		return;
 
-	if (object.has<PositionComponent>()) {
-		states.transform.translate(object.get<PositionComponent>().x, object.get<PositionComponent>().y);
+	if (auto *position = object.tryGet<PositionComponent>()) {
+		states.transform.translate(position->x, position->y);
 	}
 
-	if (object.has<HitboxComponent>()) {
-		const FloatRect *hitbox = object.get<HitboxComponent>().currentHitbox();
+	if (auto *hitboxComponent = object.tryGet<HitboxComponent>()) {
+		const FloatRect *hitbox = hitboxComponent->currentHitbox();
 		if(hitbox) {
 			RectangleShape rect;
 			rect.setPosition(hitbox->x, hitbox->y);
@@ -24,6 +24,11 @@
  *
  * =====================================================================================
  */
+#include <algorithm>
+#include <cmath>
+
+#include <glm/matrix.hpp>
+
 #include "gk/graphics/Image.hpp"
 #include "gk/graphics/RectangleShape.hpp"
 #include "gk/graphics/Sprite.hpp"
@@ -34,20 +39,106 @@
 
 namespace gk {
 
+// Bounds of the vertices of the image in the coordinates of its parent
+static FloatRect getImageBounds(const Image &image) {
+	const FloatRect &posRect = image.posRect();
+	const glm::mat4 &matrix = image.getTransform().getMatrix();
+
+	float left = INFINITY, top = INFINITY, right = -INFINITY, bottom = -INFINITY;
+	for (float x : {posRect.x, posRect.x + posRect.sizeX}) {
+		for (float y : {posRect.y, posRect.y + posRect.sizeY}) {
+			glm::vec4 corner = matrix * glm::vec4{x, y, 0.f, 1.f};
+			left = std::min(left, corner.x);
+			top = std::min(top, corner.y);
+			right = std::max(right, corner.x);
+			bottom = std::max(bottom, corner.y);
+		}
+	}
+
+	return FloatRect{left, top, right - left, bottom - top};
+}
+
+SpriteView::SpriteView() {
+	m_filter.any = componentSignature<Image, Sprite>();
+}
+
+bool SpriteView::getBounds(const SceneObject &object, FloatRect &bounds) const {
+	auto *image = object.tryGet<Image>();
+	auto *sprite = object.tryGet<Sprite>();
+	if (!image && !sprite)
+		return false;
+
+	if (image && sprite) {
+		FloatRect imageBounds = getImageBounds(*image);
+		FloatRect spriteBounds = getImageBounds(*sprite);
+
+		float left = std::min(imageBounds.x, spriteBounds.x);
+		float top = std::min(imageBounds.y, spriteBounds.y);
+		float right = std::max(imageBounds.x + imageBounds.sizeX, spriteBounds.x + spriteBounds.sizeX);
+		float bottom = std::max(imageBounds.y + imageBounds.sizeY, spriteBounds.y + spriteBounds.sizeY);
+		bounds = FloatRect{left, top, right - left, bottom - top};
+	}
+	else {
+		bounds = getImageBounds(image ? *image : *sprite);
+	}
+
+	if (auto *position = object.tryGet<PositionComponent>()) {
+		Vector2f offset = position->interpolate(interpolationAlpha());
+		bounds.x += offset.x;
+		bounds.y += offset.y;
+	}
+
+	return true;
+}
+
 void SpriteView::draw(const SceneObject &object, RenderTarget &target, RenderStates states) {
-	if (object.has<LifetimeComponent>() && object.get<LifetimeComponent>().dead(object))
+	auto *lifetime = object.tryGet<LifetimeComponent>();
+	if (lifetime && lifetime->isDead())
 		return;
 
-	if (object.has<PositionComponent>())
-		states.transform.translate({object.get<PositionComponent>(), 0.f});
+	if (auto *position = object.tryGet<PositionComponent>())
+		states.transform.translate({position->interpolate(interpolationAlpha()), 0.f});
+
+	if (m_batch) {
+		if (auto *image = object.tryGet<Image>())
+			m_batch->add(*image, states.transform);
+
+		if (auto *sprite = object.tryGet<Sprite>())
+			m_batch->add(*sprite, states.transform);
 
-	if(object.has<Image>()) {
-		target.draw(object.get<Image>(), states);
+		return;
 	}
 
-	if(object.has<Sprite>()) {
-		target.draw(object.get<Sprite>(), states);
+	if(auto *image = object.tryGet<Image>()) {
+		target.draw(*image, states);
 	}
+
+	if(auto *sprite = object.tryGet<Sprite>()) {
+		target.draw(*sprite, states);
+	}
+}
+
+void SpriteView::endDraw(RenderTarget &target, RenderStates states) {
+	if (!m_batch)
+		return;
+
+	// The quads were already transformed
+	states.transform = Transform::Identity;
+	target.draw(*m_batch, states);
+
+	m_batch->clear();
+}
+
+void SpriteView::setBatchingEnabled(bool isEnabled, bool isOrderPreserved) {
+	if (!isEnabled) {
+		m_batch.reset();
+		return;
+	}
+
+	if (!m_batch)
+		m_batch.reset(new SpriteBatch);
+
+	m_batch->setOrderPreserved(isOrderPreserved);
 }
 
 } // namespace gk
@@ -0,0 +1,122 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#ifndef AABBTREETESTS_HPP_
+#define AABBTREETESTS_HPP_
+
+#include <algorithm>
+
+#include <cxxtest/TestSuite.h>
+
+#include "gk/scene/component/HitboxComponent.hpp"
+#include "gk/scene/component/PositionComponent.hpp"
+#include "gk/scene/Scene.hpp"
+
+using namespace gk;
+
+class AABBTreeTests : public CxxTest::TestSuite  {
+	public:
+		void testTree() {
+			AABBTree tree{2.f};
+
+			std::vector<s32> leaves;
+			for (int i = 0 ; i < 1000 ; ++i)
+				leaves.emplace_back(tree.insert(FloatRect{i * 10.f, 0.f, 8.f, 8.f}, nullptr));
+
+			TS_ASSERT_EQUALS(tree.size(), 1000u);
+
+			// Balanced even though the leaves were inserted in order
+			TS_ASSERT_LESS_THAN_EQUALS(tree.height(), 20);
+
+			size_t count = 0;
+			tree.query(FloatRect{95.f, 0.f, 20.f, 1.f}, [&] (s32) { ++count; });
+			TS_ASSERT_EQUALS(count, 3u);
+
+			// Moving within the margin keeps the leaf where it is
+			TS_ASSERT(!tree.move(leaves[0], FloatRect{1.f, 1.f, 8.f, 8.f}));
+			TS_ASSERT(tree.move(leaves[0], FloatRect{500.f, 0.f, 8.f, 8.f}));
+
+			for (size_t i = 0 ; i < leaves.size() ; i += 2)
+				tree.remove(leaves[i]);
+
+			TS_ASSERT_EQUALS(tree.size(), 500u);
+			TS_ASSERT_LESS_THAN_EQUALS(tree.height(), 20);
+
+			count = 0;
+			tree.query(FloatRect{95.f, 0.f, 20.f, 1.f}, [&] (s32) { ++count; });
+			TS_ASSERT_EQUALS(count, 2u);
+		}
+
+		void testQueryRegion() {
+			Scene scene;
+
+			for (int i = 0 ; i < 100 ; ++i) {
+				SceneObject &object = scene.addObject(SceneObject{"object" + std::to_string(i)});
+				object.set<PositionComponent>(i * 20.f, 0.f);
+				object.set<HitboxComponent>(0, 0, 16, 16);
+			}
+
+			TS_ASSERT_EQUALS(scene.queryRegion(FloatRect{30.f, 0.f, 25.f, 10.f}).size(), 2u);
+
+			// Objects added, removed or moved are taken into account
+			SceneObject &object = scene.addObject(SceneObject{"new"});
+			object.set<PositionComponent>(45.f, 5.f);
+			object.set<HitboxComponent>(0, 0, 4, 4);
+			scene.objects().removeByName("object2");
+			scene.objects()[0].get<PositionComponent>().x = 50.f;
+			scene.update();
+
+			std::vector<SceneObject *> objects = scene.queryRegion(FloatRect{30.f, 0.f, 25.f, 10.f});
+			TS_ASSERT_EQUALS(objects.size(), 3u);
+			TS_ASSERT(std::find(objects.begin(), objects.end(), &object) != objects.end());
+			TS_ASSERT(std::find(objects.begin(), objects.end(), &scene.objects()[0]) != objects.end());
+
+			object.remove<HitboxComponent>();
+			TS_ASSERT_EQUALS(scene.queryRegion(FloatRect{30.f, 0.f, 25.f, 10.f}).size(), 2u);
+		}
+
+		void testRaycast() {
+			Scene scene;
+
+			for (int i = 0 ; i < 10 ; ++i) {
+				SceneObject &object = scene.addObject(SceneObject{"object" + std::to_string(i)});
+				object.set<PositionComponent>(100.f + i * 20.f, 0.f);
+				object.set<HitboxComponent>(0, 0, 16, 16);
+			}
+
+			RaycastHit hit = scene.raycast(Vector2f{0.f, 8.f}, Vector2f{2.f, 0.f}, 1000.f);
+			TS_ASSERT_EQUALS(hit.object, &scene.objects()[0]);
+			TS_ASSERT_DELTA(hit.distance, 100.f, 0.001f);
+
+			hit = scene.raycast(Vector2f{1000.f, 8.f}, Vector2f{-1.f, 0.f}, 1000.f);
+			TS_ASSERT_EQUALS(hit.object, &scene.objects()[9]);
+
+			TS_ASSERT(!scene.raycast(Vector2f{0.f, 8.f}, Vector2f{1.f, 0.f}, 50.f).object);
+			TS_ASSERT(!scene.raycast(Vector2f{0.f, 30.f}, Vector2f{1.f, 0.f}, 1000.f).object);
+		}
+};
+
+#endif // AABBTREETESTS_HPP_
@@ -0,0 +1,367 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#ifndef COLLISIONHELPERTESTS_HPP_
+#define COLLISIONHELPERTESTS_HPP_
+
+#include <set>
+
+#include <cxxtest/TestSuite.h>
+
+#include "gk/scene/component/CollisionComponent.hpp"
+#include "gk/scene/component/HitboxComponent.hpp"
+#include "gk/scene/component/MovementComponent.hpp"
+#include "gk/scene/component/PositionComponent.hpp"
+#include "gk/scene/controller/MovementController.hpp"
+#include "gk/scene/Scene.hpp"
+#include "gk/scene/SortAndSweepCollisionHelper.hpp"
+#include "gk/scene/SpatialHashCollisionHelper.hpp"
+
+using namespace gk;
+
+class CollisionHelperTests : public CxxTest::TestSuite  {
+	using PairSet = std::set<std::pair<const SceneObject *, const SceneObject *>>;
+
+	public:
+		void testSpatialHash() {
+			Scene scene;
+			checkBroadphase(scene, scene.setCollisionHelper<SpatialHashCollisionHelper>(32.f, 4.f));
+		}
+
+		void testStaticObjects() {
+			Scene spatialHashScene;
+			checkStaticObjects(spatialHashScene, spatialHashScene.setCollisionHelper<SpatialHashCollisionHelper>(32.f, 4.f));
+
+			Scene sortAndSweepScene;
+			checkStaticObjects(sortAndSweepScene, sortAndSweepScene.setCollisionHelper<SortAndSweepCollisionHelper>(4.f));
+		}
+
+		void testSortAndSweep() {
+			Scene scene;
+			checkBroadphase(scene, scene.setCollisionHelper<SortAndSweepCollisionHelper>(4.f));
+		}
+
+		void testChangesDuringActions() {
+			Scene spatialHashScene;
+			checkChangesDuringActions(spatialHashScene, spatialHashScene.setCollisionHelper<SpatialHashCollisionHelper>(32.f, 4.f));
+
+			Scene sortAndSweepScene;
+			checkChangesDuringActions(sortAndSweepScene, sortAndSweepScene.setCollisionHelper<SortAndSweepCollisionHelper>(4.f));
+		}
+
+		void testLayers() {
+			SpatialHashCollisionHelper spatialHash{32.f, 4.f};
+			SortAndSweepCollisionHelper sortAndSweep{4.f};
+			checkLayers(spatialHash);
+			checkLayers(sortAndSweep);
+
+			CollisionHelper bruteForce;
+			checkLayers(bruteForce);
+		}
+
+		void testContacts() {
+			Scene scene;
+
+			SceneObject &trigger = scene.addObject(SceneObject{"trigger"});
+			trigger.set<PositionComponent>(0.f, 0.f);
+			trigger.set<HitboxComponent>(0, 0, 16, 16);
+
+			int enterCount = 0, stayCount = 0, exitCount = 0;
+			auto &collisionComponent = trigger.set<CollisionComponent>();
+			collisionComponent.addEnterAction([&] (SceneObject &, SceneObject &) { ++enterCount; });
+			collisionComponent.addStayAction([&] (SceneObject &, SceneObject &) { ++stayCount; });
+			collisionComponent.addExitAction([&] (SceneObject &object, SceneObject &other) {
+				TS_ASSERT_EQUALS(&object, &trigger);
+				TS_ASSERT_EQUALS(other.name(), "player");
+				++exitCount;
+			});
+
+			SceneObject &player = scene.addObject(SceneObject{"player"});
+			player.set<PositionComponent>(100.f, 0.f);
+			player.set<HitboxComponent>(0, 0, 8, 8);
+
+			scene.update();
+			TS_ASSERT_EQUALS(enterCount + stayCount + exitCount, 0);
+
+			player.get<PositionComponent>().x = 8.f;
+			for (int i = 0 ; i < 3 ; ++i)
+				scene.update();
+
+			TS_ASSERT_EQUALS(enterCount, 1);
+			TS_ASSERT_EQUALS(stayCount, 2);
+			TS_ASSERT_EQUALS(exitCount, 0);
+
+			player.get<PositionComponent>().x = 100.f;
+			scene.update();
+			scene.update();
+			TS_ASSERT_EQUALS(exitCount, 1);
+
+			// A removed object ends its contacts without calling the exit actions
+			player.get<PositionComponent>().x = 8.f;
+			scene.update();
+			TS_ASSERT_EQUALS(enterCount, 2);
+
+			scene.objects().removeByName("player");
+			scene.addObject(SceneObject{"other"});
+			scene.update();
+			TS_ASSERT_EQUALS(exitCount, 1);
+			TS_ASSERT_EQUALS(stayCount, 2);
+		}
+
+		void testSleeping() {
+			Scene scene;
+			scene.addController<MovementController>();
+
+			SceneObject &wall = scene.addObject(SceneObject{"wall"});
+			wall.set<PositionComponent>(0.f, 0.f);
+			wall.set<HitboxComponent>(0, 0, 64, 16).setStatic(true);
+
+			int checkCount = 0;
+			auto addCrate = [&] (const std::string &name, float x) -> SceneObject & {
+				SceneObject crate{name};
+				crate.set<PositionComponent>(x, 0.f);
+				crate.set<HitboxComponent>(0, 0, 16, 16);
+				crate.set<MovementComponent>(nullptr).sleepDelay = 2;
+				crate.set<CollisionComponent>().addChecker([&] (SceneObject &) { ++checkCount; });
+				return scene.addObject(std::move(crate));
+			};
+
+			SceneObject &crate1 = addCrate("crate1", 0.f);
+			SceneObject &crate2 = addCrate("crate2", 16.5f);
+
+			scene.update();
+			TS_ASSERT_EQUALS(checkCount, 2);
+			TS_ASSERT(!crate1.get<MovementComponent>().isSleeping);
+
+			scene.update();
+			TS_ASSERT_EQUALS(checkCount, 2);
+			TS_ASSERT(crate1.get<MovementComponent>().isSleeping);
+
+			// Resting objects aren't tested against each other
+			CollisionHelper helper;
+			int pairCount = 0;
+			helper.forEachPair(wall, scene.objects(), [&] (SceneObject &, SceneObject &) { ++pairCount; });
+			TS_ASSERT_EQUALS(pairCount, 0);
+
+			// Moving wakes the object up, and colliding with it wakes the other one up
+			crate2.get<MovementComponent>().v.x = -1.f;
+			crate2.get<CollisionComponent>().addAction([] (SceneObject &, SceneObject &, bool) {});
+			scene.update();
+			TS_ASSERT(!crate2.get<MovementComponent>().isSleeping);
+			TS_ASSERT(!crate1.get<MovementComponent>().isSleeping);
+			TS_ASSERT_EQUALS(crate2.get<PositionComponent>().x, 15.5f);
+		}
+
+	private:
+		void checkStaticObjects(Scene &scene, CollisionHelper &helper) {
+			SceneObject &wall = scene.addObject(SceneObject{"wall"});
+			wall.set<PositionComponent>(0.f, 0.f);
+			wall.set<HitboxComponent>(0, 0, 64, 16).setStatic(true);
+
+			SceneObject &player = scene.addObject(SceneObject{"player"});
+			player.set<PositionComponent>(200.f, 0.f);
+			player.set<HitboxComponent>(0, 0, 8, 8);
+
+			CollisionHelper bruteForce;
+			helper.update(scene.objects());
+			TS_ASSERT(collidingPairs(helper, scene.objects()).empty());
+
+			// Moved static objects are found without invalidating the static grid
+			wall.get<PositionComponent>().x = 180.f;
+			helper.update(scene.objects());
+			TS_ASSERT_EQUALS(collidingPairs(helper, scene.objects()).size(), 2u);
+
+			// A static object replaced in the same slot isn't kept in the grid
+			player.get<PositionComponent>().x = 400.f;
+			SceneObjectHandle handle = wall.handle();
+			scene.objects().remove(handle);
+
+			SceneObject &block = scene.addObject(SceneObject{"block"});
+			block.set<PositionComponent>(396.f, 0.f);
+			block.set<HitboxComponent>(0, 0, 16, 16).setStatic(true);
+			TS_ASSERT_EQUALS(block.handle().index, handle.index);
+
+			helper.update(scene.objects());
+			PairSet pairs = collidingPairs(helper, scene.objects());
+			TS_ASSERT_EQUALS(pairs.size(), 2u);
+			TS_ASSERT_EQUALS(pairs, collidingPairs(bruteForce, scene.objects()));
+
+			// Overlapping static objects aren't paired
+			SceneObject &pillar = scene.addObject(SceneObject{"pillar"});
+			pillar.set<PositionComponent>(402.f, 4.f);
+			pillar.set<HitboxComponent>(0, 0, 16, 16).setStatic(true);
+
+			helper.update(scene.objects());
+			TS_ASSERT_EQUALS(collidingPairs(helper, scene.objects()), collidingPairs(bruteForce, scene.objects()));
+			TS_ASSERT_EQUALS(collidingPairs(helper, scene.objects()).size(), 4u);
+		}
+
+		void checkBroadphase(Scene &scene, CollisionHelper &helper) {
+			u32 seed = 42;
+			auto random = [&seed] (u32 max) {
+				seed = seed * 1103515245u + 12345u;
+				return s16((seed >> 16) % max);
+			};
+
+			for (int i = 0 ; i < 200 ; ++i) {
+				SceneObject &object = scene.addObject(SceneObject{"object" + std::to_string(i)});
+				object.set<PositionComponent>(float(random(1000)), float(random(1000)));
+				object.set<HitboxComponent>(0, 0, u16(random(40) + 1), u16(random(40) + 1)).setStatic(i % 7 == 0);
+
+				if (i % 10 == 0) {
+					SceneObjectList &children = object.set<SceneObjectList>();
+					SceneObject &child = children.addObject(SceneObject{"child"});
+					child.set<PositionComponent>(float(random(1000)), float(random(1000)));
+					child.set<HitboxComponent>(0, 0, 16, 16);
+				}
+			}
+
+			// Big enough to be kept out of the spatial hash grid
+			SceneObject &wall = scene.addObject(SceneObject{"wall"});
+			wall.set<PositionComponent>(0.f, 500.f);
+			wall.set<HitboxComponent>(0, 0, 1000, 10);
+
+			CollisionHelper bruteForce;
+			for (int tick = 0 ; tick < 5 ; ++tick) {
+				helper.update(scene.objects());
+
+				PairSet expected = collidingPairs(bruteForce, scene.objects());
+				TS_ASSERT(!expected.empty());
+				TS_ASSERT_EQUALS(collidingPairs(helper, scene.objects()), expected);
+
+				// Moving less than the margin doesn't require to update the broadphase
+				for (SceneObject &object : scene.objects())
+					if (!object.get<HitboxComponent>().isStatic())
+						object.get<PositionComponent>().x += float(random(7)) - 3.f;
+
+				TS_ASSERT_EQUALS(collidingPairs(helper, scene.objects()), collidingPairs(bruteForce, scene.objects()));
+
+				scene.objects().remove(size_t(random(u32(scene.objects().size() - 1))));
+			}
+
+			// Objects added after the last update are found too
+			SceneObject &object = scene.addObject(SceneObject{"new"});
+			object.set<PositionComponent>(wall.get<PositionComponent>().x, 500.f);
+			object.set<HitboxComponent>(0, 0, 8, 8);
+
+			PairSet pairs = collidingPairs(helper, scene.objects());
+			TS_ASSERT_EQUALS(pairs.count({&object, &wall}), 1u);
+			TS_ASSERT_EQUALS(pairs, collidingPairs(bruteForce, scene.objects()));
+		}
+
+		void checkChangesDuringActions(Scene &scene, CollisionHelper &helper) {
+			auto addObject = [&] (const std::string &name) -> SceneObject & {
+				SceneObject &object = scene.addObject(SceneObject{name});
+				object.set<PositionComponent>(0.f, 0.f);
+				object.set<HitboxComponent>(0, 0, 16, 16);
+				return object;
+			};
+
+			SceneObject &object = addObject("object");
+			SceneObject *removed = &addObject("removed");
+			addObject("other");
+
+			helper.update(scene.objects());
+
+			// The removed object is replaced in the same slot by a new one
+			SceneObject *added = nullptr;
+			std::set<std::string> names;
+			helper.forEachPair(object, scene.objects(), [&] (SceneObject &, SceneObject &object2) {
+				names.emplace(object2.name());
+
+				if (!added) {
+					scene.objects().remove(removed->handle());
+					added = &addObject("added");
+				}
+			});
+
+			TS_ASSERT_EQUALS(added, removed);
+			TS_ASSERT_EQUALS(names.count("added"), 0u);
+			TS_ASSERT_EQUALS(names.count("other"), 1u);
+
+			// Until the next update, the removed object is filtered out and the added one is found
+			names.clear();
+			helper.forEachPair(object, scene.objects(), [&] (SceneObject &, SceneObject &object2) {
+				names.emplace(object2.name());
+			});
+
+			TS_ASSERT_EQUALS(names, (std::set<std::string>{"added", "other"}));
+
+			// Removing the hitbox is enough to leave the broadphase
+			scene.objects().findByName("other")->remove<HitboxComponent>();
+
+			names.clear();
+			helper.forEachPair(*added, scene.objects(), [&] (SceneObject &, SceneObject &object2) {
+				names.emplace(object2.name());
+			});
+
+			TS_ASSERT_EQUALS(names, (std::set<std::string>{"object"}));
+		}
+
+		void checkLayers(CollisionHelper &helper) {
+			Scene scene;
+
+			enum : u32 { Player = 1, Bullet = 2, Wall = 4 };
+			auto addObject = [&] (const std::string &name, u32 category, u32 mask) {
+				SceneObject &object = scene.addObject(SceneObject{name});
+				object.set<PositionComponent>(0.f, 0.f);
+
+				auto &hitbox = object.set<HitboxComponent>(0, 0, 16, 16);
+				hitbox.setCategory(category);
+				hitbox.setMask(mask);
+			};
+
+			addObject("player", Player, ~0u);
+			addObject("bullet1", Bullet, Player | Wall);
+			addObject("bullet2", Bullet, Player | Wall);
+			addObject("wall", Wall, Player | Bullet);
+
+			helper.update(scene.objects());
+
+			std::set<std::pair<std::string, std::string>> pairs;
+			for (const auto &it : collidingPairs(helper, scene.objects()))
+				pairs.emplace(it.first->name(), it.second->name());
+
+			TS_ASSERT_EQUALS(pairs.size(), 10u);
+			TS_ASSERT_EQUALS(pairs.count({"bullet1", "bullet2"}), 0u);
+			TS_ASSERT_EQUALS(pairs.count({"bullet2", "bullet1"}), 0u);
+			TS_ASSERT_EQUALS(pairs.count({"bullet1", "wall"}), 1u);
+		}
+
+		PairSet collidingPairs(CollisionHelper &helper, SceneObjectList &objects) {
+			PairSet pairs;
+			for (SceneObject &object : objects) {
+				helper.forEachPair(object, objects, [&] (SceneObject &object1, SceneObject &object2) {
+					if (&object1 != &object2 && helper.inCollision(object1, object2))
+						pairs.emplace(&object1, &object2);
+				});
+			}
+
+			return pairs;
+		}
+};
+
+#endif // COLLISIONHELPERTESTS_HPP_
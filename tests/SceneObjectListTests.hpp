@@ -0,0 +1,137 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#ifndef SCENEOBJECTLISTTESTS_HPP_
+#define SCENEOBJECTLISTTESTS_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include "gk/scene/SceneObjectList.hpp"
+
+using namespace gk;
+
+class SceneObjectListTests : public CxxTest::TestSuite  {
+	public:
+		void testHandles() {
+			SceneObjectList list;
+
+			SceneObjectHandle handle1 = list.addObject(SceneObject{"object1"}).handle();
+			SceneObjectHandle handle2 = list.addObject(SceneObject{"object2"}).handle();
+			list.addObject(SceneObject{"object3"});
+
+			TS_ASSERT_EQUALS(list.get(handle1)->name(), "object1");
+			TS_ASSERT(!list.get(SceneObjectHandle{}));
+
+			// The following objects keep their order
+			list.remove(handle1);
+			TS_ASSERT(!list.get(handle1));
+			TS_ASSERT_EQUALS(list.size(), 2u);
+			TS_ASSERT_EQUALS(list[0].name(), "object2");
+			TS_ASSERT_EQUALS(list[1].name(), "object3");
+
+			// The slot is reused, but the old handle stays invalid
+			SceneObject &object4 = list.addObject(SceneObject{"object4"});
+			TS_ASSERT_EQUALS(object4.handle().index, handle1.index);
+			TS_ASSERT(!list.get(handle1));
+			TS_ASSERT_EQUALS(list.get(object4.handle()), &object4);
+
+			list.remove(handle1);
+			TS_ASSERT_EQUALS(list.size(), 3u);
+
+			list.removeByName("object2");
+			TS_ASSERT(!list.get(handle2));
+			TS_ASSERT(!list.findByName("object2"));
+		}
+
+		void testIndex() {
+			SceneObjectList list;
+			for (int i = 0 ; i < 100 ; ++i)
+				list.addObject(SceneObject{"object" + std::to_string(i), i % 10 == 0 ? "enemy" : "bullet"});
+
+			TS_ASSERT_EQUALS(list.findByName("object42")->name(), "object42");
+			TS_ASSERT(!list.findByName("object100"));
+
+			size_t enemyCount = 0;
+			list.forEachOfType("enemy", [&] (SceneObject &object) {
+				TS_ASSERT_EQUALS(object.type(), "enemy");
+				++enemyCount;
+			});
+
+			TS_ASSERT_EQUALS(enemyCount, 10u);
+
+			list.removeByName("object50");
+			list.remove(0);
+
+			enemyCount = 0;
+			list.forEachOfType("enemy", [&] (SceneObject &) { ++enemyCount; });
+			TS_ASSERT_EQUALS(enemyCount, 8u);
+
+			size_t count = 0;
+			list.forEachOfType("ghost", [&] (SceneObject &) { ++count; });
+			TS_ASSERT_EQUALS(count, 0u);
+
+			// The indices can't be bypassed by replacing an object in place
+			SceneObject &object = *list.findByName("object42");
+			TS_ASSERT_THROWS_ANYTHING(object = SceneObject{"renamed"});
+			TS_ASSERT_THROWS_ANYTHING(SceneObject{std::move(object)});
+			TS_ASSERT_EQUALS(object.name(), "object42");
+			TS_ASSERT_EQUALS(list.findByName("object42"), &object);
+			TS_ASSERT(!list.findByName("renamed"));
+		}
+
+		void testRemoveWhileIterating() {
+			SceneObjectList list;
+			for (int i = 0 ; i < 10 ; ++i)
+				list.addObject(SceneObject{"object" + std::to_string(i)});
+
+			// Removed objects are skipped, the others keep their order
+			std::string names;
+			for (SceneObject &object : list) {
+				names += object.name().back();
+				if (object.name() == "object2")
+					list.removeByName("object3");
+				if (object.name() == "object5")
+					list.remove(object.handle());
+			}
+
+			TS_ASSERT_EQUALS(names, "012456789");
+			TS_ASSERT_EQUALS(list.size(), 8u);
+			TS_ASSERT_EQUALS(list[3].name(), "object4");
+			TS_ASSERT_EQUALS(list[4].name(), "object6");
+
+			list.remove(size_t(0));
+			list.remove(size_t(0));
+			TS_ASSERT_EQUALS(list.size(), 6u);
+			TS_ASSERT_EQUALS(list[0].name(), "object2");
+
+			SceneObjectHandle handle = list.addObject(SceneObject{"object10"}).handle();
+			list.pop();
+			TS_ASSERT(!list.get(handle));
+			TS_ASSERT_EQUALS(list[list.size() - 1].name(), "object9");
+		}
+};
+
+#endif // SCENEOBJECTLISTTESTS_HPP_
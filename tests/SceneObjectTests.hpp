@@ -0,0 +1,161 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#ifndef SCENEOBJECTTESTS_HPP_
+#define SCENEOBJECTTESTS_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include "gk/scene/component/HitboxComponent.hpp"
+#include "gk/scene/component/PositionComponent.hpp"
+#include "gk/scene/SceneObjectList.hpp"
+
+using namespace gk;
+
+class SceneObjectTests : public CxxTest::TestSuite  {
+	public:
+		void testComponents() {
+			SceneObject object{"player", "entity"};
+			TS_ASSERT(!object.has<PositionComponent>());
+			TS_ASSERT_THROWS_ANYTHING(object.get<PositionComponent>());
+
+			object.set<PositionComponent>(4.f, 2.f);
+			TS_ASSERT(object.has<PositionComponent>());
+			TS_ASSERT_EQUALS(object.get<PositionComponent>(), Vector2f(4.f, 2.f));
+
+			object.set<PositionComponent>(1.f, 3.f); // replaces the previous one
+			TS_ASSERT_EQUALS(object.get<PositionComponent>(), Vector2f(1.f, 3.f));
+
+			object.remove<PositionComponent>();
+			TS_ASSERT(!object.has<PositionComponent>());
+			object.remove<PositionComponent>(); // removing a missing component is a no-op
+		}
+
+		void testSignature() {
+			SceneObject object;
+			TS_ASSERT(object.signature().none());
+			TS_ASSERT(!object.tryGet<HitboxComponent>());
+
+			// Insert in an order that differs from the type IDs
+			object.set<HitboxComponent>(1, 2, 3, 4);
+			object.set<PositionComponent>(5.f, 6.f);
+			object.set<int>(7);
+
+			TS_ASSERT_EQUALS(object.signature(), (componentSignature<HitboxComponent, PositionComponent, int>()));
+			TS_ASSERT_EQUALS(object.tryGet<HitboxComponent>()->currentHitbox()->sizeY, 4.f);
+			TS_ASSERT_EQUALS(*object.tryGet<PositionComponent>(), Vector2f(5.f, 6.f));
+			TS_ASSERT_EQUALS(*object.tryGet<int>(), 7);
+
+			object.remove<PositionComponent>();
+			TS_ASSERT(!object.tryGet<PositionComponent>());
+			TS_ASSERT_EQUALS(object.tryGet<HitboxComponent>()->currentHitbox()->x, 1.f);
+			TS_ASSERT_EQUALS(*object.tryGet<int>(), 7);
+		}
+
+		void testMove() {
+			SceneObject object{"player", "entity"};
+			PositionComponent &position = object.set<PositionComponent>(4.f, 2.f);
+
+			SceneObject other{std::move(object)};
+			TS_ASSERT(!object.has<PositionComponent>());
+			TS_ASSERT_EQUALS(&other.get<PositionComponent>(), &position); // components are not relocated
+			TS_ASSERT_EQUALS(other.name(), "player");
+
+			SceneObject third;
+			third.set<PositionComponent>(0.f, 0.f);
+			third = std::move(other);
+			TS_ASSERT_EQUALS(&third.get<PositionComponent>(), &position);
+			TS_ASSERT_EQUALS(third.type(), "entity");
+		}
+
+		void testArchetype() {
+			// Type only used here, so its archetypes have no other row
+			struct ArchetypeComponent { int value; };
+
+			std::vector<SceneObject> objects(4);
+			for (int i = 0 ; i < 4 ; ++i) {
+				objects[i].set<ArchetypeComponent>(ArchetypeComponent{i});
+				objects[i].set<PositionComponent>(float(i), 0.f);
+			}
+
+			// Objects with the same components have them in the same arrays
+			for (int i = 1 ; i < 4 ; ++i) {
+				TS_ASSERT_EQUALS(&objects[i].get<ArchetypeComponent>(), &objects[i - 1].get<ArchetypeComponent>() + 1);
+				TS_ASSERT_EQUALS(&objects[i].get<PositionComponent>(), &objects[i - 1].get<PositionComponent>() + 1);
+			}
+
+			// Adding or removing a component moves the others to another archetype
+			ArchetypeComponent *address = &objects[1].get<ArchetypeComponent>();
+			objects[1].set<HitboxComponent>(0, 0, 8, 8);
+			TS_ASSERT_DIFFERS(&objects[1].get<ArchetypeComponent>(), address);
+			TS_ASSERT_EQUALS(objects[1].get<ArchetypeComponent>().value, 1);
+			TS_ASSERT_EQUALS(objects[1].get<PositionComponent>(), Vector2f(1.f, 0.f));
+
+			objects[1].remove<HitboxComponent>();
+			TS_ASSERT_EQUALS(&objects[1].get<ArchetypeComponent>(), address); // the lowest free row is reused first
+			TS_ASSERT_EQUALS(objects[1].get<ArchetypeComponent>().value, 1);
+
+			// Replacing a component keeps its address
+			objects[2].set<ArchetypeComponent>(ArchetypeComponent{objects[2].get<ArchetypeComponent>().value + 10});
+			TS_ASSERT_EQUALS(&objects[2].get<ArchetypeComponent>(), address + 1);
+			TS_ASSERT_EQUALS(objects[2].get<ArchetypeComponent>().value, 12);
+
+			objects[3].remove<ArchetypeComponent>();
+			objects[3].remove<PositionComponent>();
+			TS_ASSERT(objects[3].signature().none());
+			objects[3].set<ArchetypeComponent>(ArchetypeComponent{7});
+			TS_ASSERT_EQUALS(objects[3].get<ArchetypeComponent>().value, 7);
+		}
+
+		void testArchetypeReuse() {
+			struct ReuseComponent { int value; };
+
+			std::vector<SceneObject> objects(4);
+			for (SceneObject &object : objects)
+				object.set<ReuseComponent>(ReuseComponent{0});
+
+			ReuseComponent *lowest = &objects[0].get<ReuseComponent>();
+
+			// The lowest freed row is reused first, whatever the release order
+			for (size_t i = objects.size() ; i-- > 0 ; )
+				objects[i].remove<ReuseComponent>();
+
+			SceneObject object;
+			TS_ASSERT_EQUALS(&object.set<ReuseComponent>(ReuseComponent{0}), lowest);
+		}
+
+		void testRelocatedChildren() {
+			SceneObject parent;
+			SceneObject &child = parent.set<SceneObjectList>().addObject(SceneObject{"child"});
+
+			// The child list is moved to another archetype, not its objects
+			parent.set<PositionComponent>(0.f, 0.f);
+			TS_ASSERT_EQUALS(&parent.get<SceneObjectList>()[0], &child);
+			TS_ASSERT_EQUALS(parent.get<SceneObjectList>().findByName("child"), &child);
+		}
+};
+
+#endif // SCENEOBJECTTESTS_HPP_
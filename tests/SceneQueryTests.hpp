@@ -0,0 +1,136 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#ifndef SCENEQUERYTESTS_HPP_
+#define SCENEQUERYTESTS_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include "gk/scene/component/HitboxComponent.hpp"
+#include "gk/scene/component/PositionComponent.hpp"
+#include "gk/scene/Scene.hpp"
+
+using namespace gk;
+
+class SceneQueryTests : public CxxTest::TestSuite  {
+	public:
+		void testQuery() {
+			Scene scene;
+
+			SceneObject &object1 = scene.addObject(SceneObject{"object1"});
+			object1.set<PositionComponent>(0.f, 0.f);
+
+			SceneObject object2{"object2"};
+			object2.set<PositionComponent>(0.f, 0.f);
+			object2.set<HitboxComponent>(0, 0, 16, 16);
+			SceneObject &object2Ref = scene.addObject(std::move(object2));
+
+			// Created after the objects, the query is filled from the scene
+			SceneQuery &query = scene.query<PositionComponent, HitboxComponent>();
+			TS_ASSERT_EQUALS(query.size(), 1u);
+			TS_ASSERT(query.contains(object2Ref));
+			TS_ASSERT_EQUALS(&query, (&scene.query<HitboxComponent, PositionComponent>()));
+
+			object1.set<HitboxComponent>(0, 0, 8, 8);
+			TS_ASSERT_EQUALS(query.size(), 2u);
+
+			object2Ref.remove<HitboxComponent>();
+			TS_ASSERT_EQUALS(query.size(), 1u);
+			TS_ASSERT(!query.contains(object2Ref));
+
+			std::vector<std::string> names;
+			query.forEach([&] (SceneObject &object) { names.emplace_back(object.name()); });
+			TS_ASSERT_EQUALS(names, std::vector<std::string>{"object1"});
+
+			scene.objects().removeByName("object1");
+			TS_ASSERT_EQUALS(query.size(), 0u);
+			TS_ASSERT(query.begin() == query.end());
+		}
+
+		void testChildren() {
+			Scene scene;
+			SceneQuery &query = scene.query<HitboxComponent>();
+
+			SceneObject parent{"parent"};
+			SceneObjectList &children = parent.set<SceneObjectList>();
+			children.addObject(SceneObject{"child1"}).set<HitboxComponent>(0, 0, 8, 8);
+
+			SceneObject &parentRef = scene.addObject(std::move(parent));
+			TS_ASSERT_EQUALS(query.size(), 1u);
+
+			// Objects added to a child list of the scene are registered too
+			SceneObject &child2 = parentRef.get<SceneObjectList>().addObject(SceneObject{"child2"});
+			child2.set<HitboxComponent>(0, 0, 8, 8);
+			TS_ASSERT_EQUALS(query.size(), 2u);
+
+			scene.objects().remove(0);
+			TS_ASSERT_EQUALS(query.size(), 0u);
+		}
+
+		void testRemoveWhileIterating() {
+			Scene scene;
+			for (int i = 0 ; i < 4 ; ++i)
+				scene.addObject(SceneObject{"object" + std::to_string(i)}).set<PositionComponent>(0.f, 0.f);
+
+			SceneQuery &query = scene.query<PositionComponent>();
+
+			std::vector<std::string> names;
+			query.forEach([&] (SceneObject &object) {
+				names.emplace_back(object.name());
+				if (object.name() == "object1")
+					scene.objects().removeByName("object2");
+			});
+
+			TS_ASSERT_EQUALS(names, (std::vector<std::string>{"object0", "object1", "object3"}));
+			TS_ASSERT_EQUALS(query.size(), 3u);
+		}
+
+		void testInsertionOrder() {
+			Scene scene;
+			SceneQuery &query = scene.query<PositionComponent>();
+
+			for (int i = 0 ; i < 5 ; ++i)
+				scene.addObject(SceneObject{"object" + std::to_string(i)}).set<PositionComponent>(0.f, 0.f);
+
+			// Objects that start matching later still go to their place
+			scene.objects()[1].remove<PositionComponent>();
+			scene.objects()[1].set<PositionComponent>(0.f, 0.f);
+
+			scene.objects().removeByName("object0");
+			scene.addObject(SceneObject{"object5"}).set<PositionComponent>(0.f, 0.f);
+
+			std::vector<std::string> names;
+			query.forEach([&] (SceneObject &object) { names.emplace_back(object.name()); });
+			TS_ASSERT_EQUALS(names, (std::vector<std::string>{"object1", "object2", "object3", "object4", "object5"}));
+
+			names.clear();
+			for (SceneObject &object : scene.objects())
+				names.emplace_back(object.name());
+			TS_ASSERT_EQUALS(names, (std::vector<std::string>{"object1", "object2", "object3", "object4", "object5"}));
+		}
+};
+
+#endif // SCENEQUERYTESTS_HPP_
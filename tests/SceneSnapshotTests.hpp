@@ -0,0 +1,200 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#ifndef SCENESNAPSHOTTESTS_HPP_
+#define SCENESNAPSHOTTESTS_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include "gk/scene/component/PositionComponent.hpp"
+#include "gk/scene/Scene.hpp"
+#include "gk/scene/SceneSnapshot.hpp"
+
+using namespace gk;
+
+struct Inventory {
+	std::vector<u32> items;
+};
+
+namespace gk {
+	template<>
+	struct SnapshotTraits<Inventory> {
+		static void save(const Inventory &inventory, SnapshotWriter &writer) {
+			writer.write(static_cast<u32>(inventory.items.size()));
+			writer.writeBytes(inventory.items.data(), inventory.items.size() * sizeof(u32));
+		}
+
+		static void load(SceneObject &object, SnapshotReader &reader) {
+			Inventory *inventory = object.tryGet<Inventory>();
+			if (!inventory)
+				inventory = &object.set<Inventory>();
+
+			u32 size = 0;
+			reader.read(size);
+			inventory->items.resize(size);
+			reader.readBytes(inventory->items.data(), size * sizeof(u32));
+		}
+	};
+}
+
+class SceneSnapshotTests : public CxxTest::TestSuite  {
+	struct Unregistered {
+		int value = 0;
+	};
+
+	public:
+		void testRestore() {
+			SceneSnapshot::registerComponent<PositionComponent>();
+			SceneSnapshot::registerComponent<Inventory>();
+
+			SceneObjectList objects;
+			for (int i = 0 ; i < 100 ; ++i) {
+				SceneObject &object = objects.addObject(SceneObject{"object" + std::to_string(i), "test"});
+				object.set<PositionComponent>(float(i), 0.f);
+
+				if (i % 10 == 0) {
+					object.set<Inventory>().items = {u32(i), 1, 2};
+
+					SceneObjectList &children = object.set<SceneObjectList>();
+					children.addObject(SceneObject{"child"}).set<PositionComponent>(1.f, 2.f);
+				}
+			}
+
+			SceneSnapshot snapshot;
+			snapshot.save(objects);
+
+			// Changes reverted by restore()
+			SceneObject *first = &objects[0];
+			first->set<Unregistered>().value = 7;
+			Inventory *inventory = &first->get<Inventory>(); // adding a component moved it
+			first->get<PositionComponent>().x = 42.f;
+			first->get<Inventory>().items.clear();
+			first->get<SceneObjectList>().pop();
+			objects[1].set<Inventory>();
+			objects.remove(objects.size() - 1);
+			objects.addObject(SceneObject{"extra"});
+			objects.addObject(SceneObject{"extra2"});
+
+			snapshot.restore(objects);
+
+			TS_ASSERT_EQUALS(objects.size(), 100u);
+			TS_ASSERT_EQUALS(&objects[0], first);
+			TS_ASSERT_EQUALS(&first->get<Inventory>(), inventory);
+			TS_ASSERT_EQUALS(first->get<PositionComponent>().x, 0.f);
+			TS_ASSERT_EQUALS(first->get<Inventory>().items, std::vector<u32>({0, 1, 2}));
+			TS_ASSERT_EQUALS(first->get<SceneObjectList>().size(), 1u);
+			TS_ASSERT_EQUALS(first->get<SceneObjectList>()[0].get<PositionComponent>().y, 2.f);
+			TS_ASSERT_EQUALS(first->get<Unregistered>().value, 7);
+			TS_ASSERT(!objects[1].has<Inventory>());
+
+			TS_ASSERT_EQUALS(objects[99].name(), "object99");
+			TS_ASSERT_EQUALS(objects[99].get<PositionComponent>().x, 99.f);
+			TS_ASSERT_EQUALS(objects.findByName("object99"), &objects[99]);
+			TS_ASSERT(!objects.findByName("extra"));
+
+			// Snapshots can be restored into another list
+			SceneObjectList copy;
+			snapshot.restore(copy);
+			TS_ASSERT_EQUALS(copy.size(), 100u);
+			TS_ASSERT_EQUALS(copy[50].get<Inventory>().items[0], 50u);
+
+			std::vector<u8> data = snapshot.data();
+			data.resize(data.size() / 2);
+			snapshot.setData(std::move(data));
+			TS_ASSERT_THROWS_ANYTHING(snapshot.restore(copy));
+		}
+
+		void testRestoreHandles() {
+			SceneSnapshot::registerComponent<PositionComponent>();
+
+			SceneObjectList objects;
+			std::vector<SceneObjectHandle> handles;
+			for (int i = 0 ; i < 10 ; ++i) {
+				SceneObject &object = objects.addObject(SceneObject{"object" + std::to_string(i)});
+				object.set<PositionComponent>(float(i), 0.f);
+				handles.emplace_back(object.handle());
+			}
+
+			SceneSnapshot snapshot;
+			snapshot.save(objects);
+
+			// The slot of the removed object is reused by an object with a component that isn't saved
+			objects.remove(handles[3]);
+			objects.addObject(SceneObject{"new"}).set<Unregistered>().value = 1;
+
+			SceneObject *object4 = objects.get(handles[4]);
+			object4->set<Unregistered>().value = 4;
+
+			snapshot.restore(objects);
+
+			TS_ASSERT_EQUALS(objects.size(), 10u);
+			for (size_t i = 0 ; i < 10 ; ++i) {
+				SceneObject *object = objects.get(handles[i]);
+				TS_ASSERT_EQUALS(object, &objects[i]);
+				TS_ASSERT_EQUALS(object->name(), "object" + std::to_string(i));
+				TS_ASSERT_EQUALS(object->get<PositionComponent>().x, float(i));
+			}
+
+			TS_ASSERT(!objects.get(handles[3])->has<Unregistered>());
+			TS_ASSERT_EQUALS(objects.get(handles[4]), object4);
+			TS_ASSERT_EQUALS(object4->get<Unregistered>().value, 4);
+			TS_ASSERT(!objects.findByName("new"));
+
+			// New objects get the handles they would have got after the snapshot was saved
+			SceneObjectHandle handle = objects.addObject(SceneObject{"new"}).handle();
+			TS_ASSERT_EQUALS(handle.index, 10u);
+			TS_ASSERT_EQUALS(handle.generation, 0u);
+		}
+
+		void testRestoreInsertionOrder() {
+			SceneSnapshot::registerComponent<PositionComponent>();
+
+			Scene scene;
+			SceneQuery &query = scene.query<PositionComponent>();
+			for (int i = 0 ; i < 10 ; ++i)
+				scene.addObject(SceneObject{"object" + std::to_string(i)}).set<PositionComponent>(float(i), 0.f);
+
+			SceneSnapshot snapshot;
+			snapshot.save(scene.objects());
+
+			// The recreated objects are back at their place among the others
+			scene.objects().remove(size_t(3));
+			scene.objects().remove(size_t(0));
+			scene.addObject(SceneObject{"extra"}).set<PositionComponent>(0.f, 0.f);
+
+			snapshot.restore(scene.objects());
+			scene.addObject(SceneObject{"new"}).set<PositionComponent>(10.f, 0.f);
+
+			std::vector<float> positions;
+			query.forEach([&] (SceneObject &object) {
+				positions.emplace_back(object.get<PositionComponent>().x);
+			});
+
+			TS_ASSERT_EQUALS(positions, std::vector<float>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10}));
+		}
+};
+
+#endif // SCENESNAPSHOTTESTS_HPP_
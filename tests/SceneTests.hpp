@@ -0,0 +1,539 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#ifndef SCENETESTS_HPP_
+#define SCENETESTS_HPP_
+
+#include <algorithm>
+
+#include <cxxtest/TestSuite.h>
+
+#include "gk/core/GameClock.hpp"
+#include "gk/scene/component/CollisionComponent.hpp"
+#include "gk/scene/component/LifetimeComponent.hpp"
+#include "gk/scene/component/MovementComponent.hpp"
+#include "gk/scene/component/PositionComponent.hpp"
+#include "gk/scene/component/UpdateRateComponent.hpp"
+#include "gk/scene/controller/EasyController.hpp"
+#include "gk/scene/controller/LifetimeController.hpp"
+#include "gk/scene/controller/MovementController.hpp"
+#include "gk/scene/controller/UpdateRateController.hpp"
+#include "gk/scene/movement/EasyMovement.hpp"
+#include "gk/scene/Scene.hpp"
+
+using namespace gk;
+
+class SceneTests : public CxxTest::TestSuite  {
+	struct Counter {
+		int value = 0;
+	};
+
+	struct Speed {
+		int value = 1;
+	};
+
+	public:
+		void testParallelUpdate() {
+			std::vector<std::string> serialSpawns, parallelSpawns;
+			std::vector<int> serialResults = runParallelUpdate(1, serialSpawns);
+			std::vector<int> parallelResults = runParallelUpdate(4, parallelSpawns);
+
+			TS_ASSERT_EQUALS(serialResults.size(), 1000u);
+			TS_ASSERT_EQUALS(serialResults, parallelResults);
+
+			// Commands recorded by the tasks are applied in the order of the objects
+			TS_ASSERT_EQUALS(serialSpawns.size(), 1000u);
+			TS_ASSERT_EQUALS(serialSpawns, parallelSpawns);
+			TS_ASSERT_EQUALS(serialSpawns[999], "spawned999");
+
+			// Speeds are doubled after being added: 1 + 2 + 4
+			TS_ASSERT_EQUALS(serialResults[0], 7);
+		}
+
+		void testCommandBuffer() {
+			GameClock clock;
+			GameClock::setInstance(clock);
+
+			Scene scene;
+			scene.addController<LifetimeController>();
+
+			for (int i = 0 ; i < 1000 ; ++i) {
+				SceneObject &object = scene.addObject(SceneObject{"object" + std::to_string(i)});
+				object.set<Counter>();
+
+				LifetimeComponent &lifetime = object.set<LifetimeComponent>();
+				lifetime.setClientsNotified(true);
+				if (i % 2 == 0)
+					lifetime.kill();
+			}
+
+			// Changes made during the update aren't visible until the end of it
+			size_t objectCount = 0;
+			scene.addController<EasyController>([&] (SceneObject &object) {
+				++objectCount;
+
+				if (object.name() == "object1") {
+					scene.commands().spawn(scene.objects(), SceneObject{"spawned"});
+					scene.commands().set<Speed>(object);
+					scene.commands().remove<Counter>(object);
+					scene.commands().destroy(scene.objects()[1]);
+					TS_ASSERT(scene.objects()[1].isDestroyed());
+				}
+			});
+
+			scene.update();
+
+			// Objects killed before the update were removed after the global controllers
+			TS_ASSERT_EQUALS(objectCount, 500u);
+			TS_ASSERT_EQUALS(scene.objects().size(), 500u);
+			TS_ASSERT_EQUALS(scene.objects()[0].name(), "object1");
+			TS_ASSERT(scene.objects()[0].has<Speed>());
+			TS_ASSERT(!scene.objects()[0].has<Counter>());
+			TS_ASSERT_EQUALS(scene.objects()[1].name(), "object5");
+			TS_ASSERT_EQUALS(scene.objects()[499].name(), "spawned");
+			TS_ASSERT(scene.commands().empty());
+		}
+
+		void testSpawnInMovedList() {
+			Scene scene;
+
+			SceneObject &parent = scene.addObject(SceneObject{"parent"});
+			parent.set<SceneObjectList>();
+
+			scene.addController<EasyController>([&] (SceneObject &object) {
+				if (&object == &parent) {
+					scene.commands().spawn(parent.get<SceneObjectList>(), SceneObject{"child"});
+
+					// Applied before the spawn, and moves the child list to another archetype
+					scene.commands().set<Counter>(parent);
+				}
+			});
+
+			scene.update();
+
+			TS_ASSERT(parent.has<Counter>());
+			TS_ASSERT_EQUALS(parent.get<SceneObjectList>().size(), 1u);
+			TS_ASSERT_EQUALS(parent.get<SceneObjectList>()[0].parent(), &parent);
+		}
+
+		void testDeathState() {
+			GameClock clock;
+			GameClock::setInstance(clock);
+
+			Scene scene;
+			scene.addController<LifetimeController>();
+
+			int checkCount = 0, updateCount = 0;
+			SceneObject &object = scene.addObject(SceneObject{"object"});
+			object.set<LifetimeComponent>([&] (const SceneObject &) { return ++checkCount >= 3; });
+
+			// Controllers read the state evaluated by LifetimeController
+			scene.addController<EasyController>([&] (SceneObject &object) {
+				if (!object.get<LifetimeComponent>().isDead())
+					++updateCount;
+			});
+
+			scene.update();
+			scene.update();
+			TS_ASSERT_EQUALS(checkCount, 2);
+			TS_ASSERT_EQUALS(updateCount, 2);
+
+			scene.update();
+			TS_ASSERT_EQUALS(checkCount, 3);
+			TS_ASSERT_EQUALS(updateCount, 2);
+
+			// Not removed until the clients are notified
+			object.get<LifetimeComponent>().setClientsNotified(true);
+			scene.update();
+			TS_ASSERT_EQUALS(scene.objects().size(), 0u);
+		}
+
+		void testLifetimeChecks() {
+			GameClock clock;
+			GameClock::setInstance(clock);
+
+			Scene scene;
+			scene.addController<LifetimeController>();
+
+			for (int i = 0 ; i < 10 ; ++i)
+				scene.addObject(SceneObject{"object" + std::to_string(i)}).set<LifetimeComponent>().setClientsNotified(true);
+
+			scene.update();
+			TS_ASSERT_EQUALS(scene.objects().size(), 10u);
+
+			// Objects already seen by the controller are checked again when they change
+			int checkCount = 0;
+			scene.objects()[2].get<LifetimeComponent>().kill();
+			scene.objects()[5].get<LifetimeComponent>().setDeathChecker([&] (const SceneObject &) {
+				return ++checkCount >= 2;
+			});
+
+			scene.update();
+			TS_ASSERT_EQUALS(scene.objects().size(), 9u);
+			TS_ASSERT_EQUALS(checkCount, 1);
+
+			scene.update();
+			TS_ASSERT_EQUALS(scene.objects().size(), 8u);
+			TS_ASSERT_EQUALS(checkCount, 2);
+
+			// A replaced component is seen as new
+			LifetimeComponent lifetime;
+			lifetime.setClientsNotified(true);
+			lifetime.kill();
+			scene.objects()[0].set<LifetimeComponent>(lifetime);
+
+			scene.update();
+			TS_ASSERT_EQUALS(scene.objects().size(), 7u);
+			TS_ASSERT_EQUALS(scene.objects()[0].name(), "object1");
+		}
+
+		void testDeadChildren() {
+			GameClock clock;
+			GameClock::setInstance(clock);
+
+			Scene scene;
+			scene.addController<LifetimeController>();
+
+			SceneObject &parent = scene.addObject(SceneObject{"parent"});
+			SceneObject &child = parent.set<SceneObjectList>().addObject(SceneObject{"child"});
+			child.set<LifetimeComponent>();
+
+			LifetimeComponent &lifetime = parent.set<LifetimeComponent>();
+			lifetime.setClientsNotified(true);
+			lifetime.kill();
+
+			// Dead objects are kept until their children are dead
+			scene.update();
+			TS_ASSERT_EQUALS(scene.objects().size(), 1u);
+
+			child.get<LifetimeComponent>().kill();
+			scene.update();
+			TS_ASSERT_EQUALS(scene.objects().size(), 0u);
+		}
+
+		void testMovement() {
+			Scene scene;
+			scene.addController<MovementController>();
+
+			// Enough objects to go through the vectorized and the scalar paths
+			for (int i = 0 ; i < 13 ; ++i) {
+				SceneObject &object = scene.addObject(SceneObject{"object" + std::to_string(i)});
+				object.set<PositionComponent>(float(i), 0.f);
+
+				auto &movement = object.set<MovementComponent>(nullptr);
+				movement.v = {i % 5 ? 1.f : 0.f, float(-i)};
+				movement.speed = 0.5f;
+			}
+
+			// Checked after the objects above, so it must see their new position
+			Vector2f position;
+			SceneObject &collider = scene.addObject(SceneObject{"collider"});
+			collider.set<PositionComponent>(0.f, 0.f);
+			collider.set<CollisionComponent>().addChecker([&] (SceneObject &) {
+				position = scene.objects()[12].get<PositionComponent>();
+			});
+
+			scene.update();
+
+			for (int i = 0 ; i < 13 ; ++i) {
+				const SceneObject &object = scene.objects()[size_t(i)];
+				TS_ASSERT_EQUALS(object.get<PositionComponent>().x, float(i) + (i % 5 ? 0.5f : 0.f));
+				TS_ASSERT_EQUALS(object.get<PositionComponent>().y, float(-i) * 0.5f);
+				TS_ASSERT_EQUALS(object.get<MovementComponent>().isMoving, i != 0);
+			}
+
+			TS_ASSERT_EQUALS(position.x, 12.5f);
+			TS_ASSERT_EQUALS(position.y, -6.f);
+		}
+
+		void testBatchedMovement() {
+			std::vector<float> batchedResults = runMovement(true);
+			std::vector<float> singleResults = runMovement(false);
+
+			TS_ASSERT_LESS_THAN(600u * 4, batchedResults.size());
+			TS_ASSERT_EQUALS(batchedResults, singleResults);
+		}
+
+		void testUpdateRate() {
+			Scene scene;
+			scene.addController<UpdateRateController>(100.f, 3).addPointOfInterest({0, 0});
+			scene.addController<MovementController>();
+
+			// Levels 0 to 3, with 8 objects per level to check they are spread across ticks
+			const float distances[] = {50.f, 150.f, 300.f, 1000.f};
+			for (float distance : distances) {
+				for (int i = 0 ; i < 8 ; ++i) {
+					SceneObject &object = scene.addObject(SceneObject{"object"});
+					object.set<PositionComponent>(distance, 0.f);
+					object.set<MovementComponent>(nullptr).v = {0.f, 1.f};
+					object.set<UpdateRateComponent>();
+				}
+			}
+
+			for (int tick = 0 ; tick < 16 ; ++tick) {
+				scene.update();
+
+				size_t dueCount[4] = {0, 0, 0, 0};
+				for (const SceneObject &object : scene.objects()) {
+					auto &rate = object.get<UpdateRateComponent>();
+					if (rate.isDue())
+						++dueCount[rate.level()];
+				}
+
+				TS_ASSERT_EQUALS(dueCount[0], 8u);
+				TS_ASSERT_EQUALS(dueCount[1], 4u);
+				TS_ASSERT_EQUALS(dueCount[2], 2u);
+				TS_ASSERT_EQUALS(dueCount[3], 1u);
+			}
+
+			// Skipped ticks are integrated when the objects are updated, so they
+			// all moved by 16 ticks except the ones not updated since
+			for (const SceneObject &object : scene.objects()) {
+				auto &rate = object.get<UpdateRateComponent>();
+				float y = object.get<PositionComponent>().y;
+				TS_ASSERT_LESS_THAN_EQUALS(16.f - float(rate.interval() - 1), y);
+				TS_ASSERT_LESS_THAN_EQUALS(y, 16.f);
+			}
+		}
+
+		void testUpdateRateTick() {
+			Scene scene;
+			scene.addController<UpdateRateController>(100.f, 3).addPointOfInterest({0, 0});
+
+			SceneObject &object = scene.addObject(SceneObject{"object"});
+			object.set<PositionComponent>(1000.f, 0.f);
+			object.set<UpdateRateComponent>();
+
+			// Colliders are due every tick whatever their distance
+			SceneObject &collider = scene.addObject(SceneObject{"collider"});
+			collider.set<PositionComponent>(1000.f, 0.f);
+			collider.set<UpdateRateComponent>();
+			collider.set<CollisionComponent>();
+
+			size_t objectCount = 0, colliderCount = 0;
+			for (int tick = 0 ; tick < 16 ; ++tick) {
+				scene.update();
+				objectCount += object.get<UpdateRateComponent>().isDue();
+				colliderCount += collider.get<UpdateRateComponent>().isDue();
+			}
+
+			TS_ASSERT_EQUALS(objectCount, 2u);
+			TS_ASSERT_EQUALS(colliderCount, 16u);
+			TS_ASSERT_EQUALS(collider.get<UpdateRateComponent>().level(), 3);
+
+			// Updating objects one by one doesn't advance the tick
+			scene.update(object);
+			bool isDue = object.get<UpdateRateComponent>().isDue();
+			for (int i = 0 ; i < 8 ; ++i) {
+				scene.update(object);
+				TS_ASSERT_EQUALS(object.get<UpdateRateComponent>().isDue(), isDue);
+			}
+		}
+
+		void testUpdateRateMaxLevel() {
+			// Intervals above 15 levels don't fit in 16 bits
+			UpdateRateComponent rate;
+			rate.setLevel(20);
+			TS_ASSERT_EQUALS(rate.level(), 15);
+			TS_ASSERT_EQUALS(rate.interval(), 0x8000);
+
+			Scene scene;
+			scene.addController<UpdateRateController>(1.f, 40).addPointOfInterest({0, 0});
+
+			SceneObject &object = scene.addObject(SceneObject{"object"});
+			object.set<PositionComponent>(1e9f, 0.f);
+			object.set<UpdateRateComponent>();
+
+			scene.update();
+			TS_ASSERT_EQUALS(object.get<UpdateRateComponent>().level(), 15);
+		}
+
+		void testInterpolation() {
+			Scene scene;
+			scene.addController<MovementController>();
+
+			SceneObject &object = scene.addObject(SceneObject{"object"});
+			object.set<PositionComponent>(0.f, 0.f);
+			object.set<MovementComponent>(nullptr).v = {2.f, 0.f};
+
+			// Previous positions are only saved if enabled
+			scene.update();
+			TS_ASSERT_EQUALS(object.get<PositionComponent>().previous(), Vector2f(0.f, 0.f));
+
+			scene.setInterpolationEnabled(true);
+			scene.update();
+
+			auto &position = object.get<PositionComponent>();
+			TS_ASSERT_EQUALS(position.previous(), Vector2f(2.f, 0.f));
+			TS_ASSERT_EQUALS(position, Vector2f(4.f, 0.f));
+			TS_ASSERT_EQUALS(position.interpolate(0.5f), Vector2f(3.f, 0.f));
+			TS_ASSERT_EQUALS(position.interpolate(1.f), Vector2f(4.f, 0.f));
+
+			// Setting the position keeps the previous one
+			position = Vector2f{10.f, 0.f};
+			TS_ASSERT_EQUALS(position.previous(), Vector2f(2.f, 0.f));
+		}
+
+		void testProfiler() {
+			Scene scene;
+			TS_ASSERT(!scene.profiler());
+
+			for (int i = 0 ; i < 10 ; ++i)
+				scene.addObject(SceneObject{"object" + std::to_string(i)}).set<Counter>();
+
+			scene.addController<EasyController>([] (SceneObject &object) {
+				++object.get<Counter>().value;
+			});
+
+			scene.setProfilingEnabled(true);
+			for (int i = 0 ; i < 5 ; ++i)
+				scene.update();
+
+			std::vector<SceneProfiler::Stats> stats = scene.profiler()->stats();
+			auto it = std::find_if(stats.begin(), stats.end(), [] (const SceneProfiler::Stats &stats) {
+				return stats.name.find("EasyController") != std::string::npos;
+			});
+
+			TS_ASSERT(it != stats.end());
+			TS_ASSERT_EQUALS(it->sampleCount, 5u);
+			TS_ASSERT_EQUALS(it->objectCount, 10u);
+			TS_ASSERT_LESS_THAN_EQUALS(it->minTime, it->averageTime);
+			TS_ASSERT_LESS_THAN_EQUALS(it->averageTime, it->p99Time);
+
+			// The collision phase is sampled as the collision helper
+			TS_ASSERT_EQUALS(stats.size(), 3u);
+			TS_ASSERT_EQUALS(stats[1].name, "gk::CollisionHelper");
+			TS_ASSERT_EQUALS(stats[1].sampleCount, 5u);
+			TS_ASSERT_EQUALS(stats[2].name, "gk::SceneCommandBuffer");
+		}
+
+	private:
+		// Positions and states of the objects, and positions read by collision checks
+		std::vector<float> runMovement(bool isBatchingEnabled) {
+			Scene scene;
+			scene.addController<UpdateRateController>();
+			scene.addController<MovementController>().setBatchingEnabled(isBatchingEnabled);
+
+			std::vector<float> results;
+
+			// More objects than a batch, mixed with ones that can't be batched
+			for (int i = 0 ; i < 600 ; ++i) {
+				SceneObject &object = scene.addObject(SceneObject{"object" + std::to_string(i)});
+				object.set<PositionComponent>(float(i), 0.f);
+
+				Movement *movement = nullptr;
+				if (i % 17 == 0)
+					movement = new EasyMovement([] (SceneObject &object) { object.get<MovementComponent>().v.x *= -1.f; });
+
+				auto &movementComponent = object.set<MovementComponent>(movement);
+				movementComponent.v = {float(i % 9) * 0.37f - 1.f, float(i % 5) * 0.21f};
+				movementComponent.speed = 0.5f + float(i % 3) * 0.25f;
+
+				if (i % 7 == 0) {
+					movementComponent.v = {0.f, 0.f};
+					movementComponent.sleepDelay = 2;
+				}
+
+				if (i % 13 == 0)
+					object.set<UpdateRateComponent>().setLevel(u8(i % 3));
+
+				if (i % 11 == 10) {
+					object.set<CollisionComponent>().addChecker([&results, &scene, i] (SceneObject &) {
+						const PositionComponent &position = scene.objects()[size_t(i - 1)].get<PositionComponent>();
+						results.emplace_back(position.x);
+						results.emplace_back(position.y);
+					});
+				}
+			}
+
+			for (int i = 0 ; i < 6 ; ++i)
+				scene.update();
+
+			for (const SceneObject &object : scene.objects()) {
+				const auto &movementComponent = object.get<MovementComponent>();
+				results.emplace_back(object.get<PositionComponent>().x);
+				results.emplace_back(object.get<PositionComponent>().y);
+				results.emplace_back(float(movementComponent.isMoving));
+				results.emplace_back(float(movementComponent.isSleeping));
+			}
+
+			return results;
+		}
+
+		std::vector<int> runParallelUpdate(u16 threadCount, std::vector<std::string> &spawns) {
+			Scene scene;
+			scene.setThreadCount(threadCount);
+
+			for (int i = 0 ; i < 1000 ; ++i) {
+				SceneObject &object = scene.addObject(SceneObject{"object" + std::to_string(i)});
+				object.set<Counter>();
+				object.set<Speed>();
+			}
+
+			scene.addController<EasyController>([] (SceneObject &object) {
+				object.get<Counter>().value += object.get<Speed>().value;
+			}).reads<Speed>().writes<Counter>().setDataParallel(true);
+
+			// Writes Speed, which the controller above reads, so runs after it
+			scene.addController<EasyController>([] (SceneObject &object) {
+				object.get<Speed>().value *= 2;
+			}).writes<Speed>().setDataParallel(true);
+
+			SceneObjectList spawnedObjects;
+			scene.addController<EasyController>([&] (SceneObject &object) {
+				// Objects are built by the tasks, which allocate their components at the same time
+				if (object.get<Counter>().value == 1) {
+					SceneObject spawned{"spawned" + object.name().substr(6)};
+					spawned.set<Counter>(Counter{std::stoi(object.name().substr(6))});
+					scene.commands().spawn(spawnedObjects, std::move(spawned));
+				}
+			}).reads<Counter>().setDataParallel(true);
+
+			// Runs alone, since it doesn't declare what it accesses
+			int objectCount = 0;
+			scene.addController<EasyController>([&] (SceneObject &) {
+				++objectCount;
+			});
+
+			for (int i = 0 ; i < 3 ; ++i)
+				scene.update();
+
+			TS_ASSERT_EQUALS(objectCount, 3000);
+
+			std::vector<int> results;
+			for (SceneObject &object : scene.objects())
+				results.emplace_back(object.get<Counter>().value);
+
+			for (SceneObject &object : spawnedObjects) {
+				TS_ASSERT_EQUALS(object.get<Counter>().value, std::stoi(object.name().substr(7)));
+				spawns.emplace_back(object.name());
+			}
+
+			return results;
+		}
+};
+
+#endif // SCENETESTS_HPP_
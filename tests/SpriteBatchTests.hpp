@@ -0,0 +1,75 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#ifndef SPRITEBATCHTESTS_HPP_
+#define SPRITEBATCHTESTS_HPP_
+
+#include <type_traits>
+
+#include <cxxtest/TestSuite.h>
+
+#include "gk/gl/Texture.hpp"
+#include "gk/graphics/SpriteBatch.hpp"
+
+using namespace gk;
+
+class SpriteBatchTests : public CxxTest::TestSuite  {
+	public:
+		void testOrderPreserved() {
+			SpriteBatch batch;
+			TS_ASSERT(batch.isOrderPreserved());
+
+			addQuads(batch);
+			TS_ASSERT_EQUALS(batch.size(), 4u);
+			TS_ASSERT_EQUALS(batch.drawCallCount(), 3u);
+		}
+
+		void testReordered() {
+			SpriteBatch batch;
+			batch.setOrderPreserved(false);
+
+			addQuads(batch);
+			TS_ASSERT_EQUALS(batch.size(), 4u);
+			TS_ASSERT_EQUALS(batch.drawCallCount(), 2u);
+		}
+
+	private:
+		// Quads using the textures 1, 1, 2, 1
+		void addQuads(SpriteBatch &batch) {
+			// Only the addresses of the textures are used until the batch is drawn
+			static std::aligned_storage<sizeof(Texture), alignof(Texture)>::type storage[2];
+			const Texture *texture1 = reinterpret_cast<const Texture *>(&storage[0]);
+			const Texture *texture2 = reinterpret_cast<const Texture *>(&storage[1]);
+
+			Vertex vertices[4];
+			batch.add(texture1, vertices);
+			batch.add(texture1, vertices);
+			batch.add(texture2, vertices);
+			batch.add(texture1, vertices);
+		}
+};
+
+#endif // SPRITEBATCHTESTS_HPP_
@@ -0,0 +1,67 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#ifndef THREADPOOLTESTS_HPP_
+#define THREADPOOLTESTS_HPP_
+
+#include <atomic>
+
+#include <cxxtest/TestSuite.h>
+
+#include "gk/core/Exception.hpp"
+#include "gk/core/ThreadPool.hpp"
+
+using namespace gk;
+
+class ThreadPoolTests : public CxxTest::TestSuite  {
+	public:
+		void testRun() {
+			ThreadPool pool{3};
+			TS_ASSERT_EQUALS(pool.workerCount(), 3);
+
+			std::vector<int> values(1000, 0);
+			for (int batch = 0 ; batch < 50 ; ++batch)
+				pool.run(values.size(), [&] (size_t i) { ++values[i]; });
+
+			TS_ASSERT_EQUALS(values, std::vector<int>(1000, 50));
+		}
+
+		void testException() {
+			ThreadPool pool{2};
+
+			std::atomic<int> count{0};
+			TS_ASSERT_THROWS_ANYTHING(pool.run(100, [&] (size_t i) {
+				++count;
+				if (i == 10)
+					throw EXCEPTION("Task failed");
+			}));
+
+			// The other tasks are still run
+			TS_ASSERT_EQUALS(count.load(), 100);
+		}
+};
+
+#endif // THREADPOOLTESTS_HPP_
@@ -0,0 +1,134 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#ifndef TILEMAPANIMATIONTABLETESTS_HPP_
+#define TILEMAPANIMATIONTABLETESTS_HPP_
+
+#include <utility>
+
+#include <cxxtest/TestSuite.h>
+
+#include "gk/graphics/tilemap/TilemapAnimationTable.hpp"
+
+using namespace gk;
+
+using Texel = std::pair<u16, u16>;
+
+class TilemapAnimationTableTests : public CxxTest::TestSuite  {
+	public:
+		void testSetTexel() {
+			u8 texel[4];
+			TilemapAnimationTable::setTexel(texel, 0x1234, 0xabcd);
+
+			TS_ASSERT_EQUALS(texel[0], 0x34);
+			TS_ASSERT_EQUALS(texel[1], 0x12);
+			TS_ASSERT_EQUALS(texel[2], 0xcd);
+			TS_ASSERT_EQUALS(texel[3], 0xab);
+		}
+
+		void testIndexRows() {
+			TilemapAnimationTable table{300, 1};
+			TS_ASSERT_EQUALS(table.height(), 2);
+			TS_ASSERT_EQUALS(table.period(), TilemapAnimationTable::maxPeriod);
+			TS_ASSERT_EQUALS(table.pixels().size(), 2u * TilemapAnimationTable::width * 4);
+
+			for (u8 value : table.pixels())
+				TS_ASSERT_EQUALS(value, 0);
+
+			TS_ASSERT_EQUALS(TilemapAnimationTable(0, 0).height(), 1);
+		}
+
+		void testAnimations() {
+			Tile water;
+			water.addAnimationFrame(3, 100);
+			water.addAnimationFrame(4, 200);
+
+			Tile lava;
+			lava.addAnimationFrame(271, 250);
+
+			TilemapAnimationTable table{300, 1};
+			table.addAnimation(2, water);
+			table.addAnimation(270, lava);
+
+			TS_ASSERT_EQUALS(table.height(), 4);
+			TS_ASSERT_EQUALS(table.period(), 1500u * (TilemapAnimationTable::maxPeriod / 1500u));
+
+			// IDs are stored without the tileset offset
+			TS_ASSERT_EQUALS(texel(table, 1, 0), Texel(2, 0));
+			TS_ASSERT_EQUALS(texel(table, 269 % 256, 269 / 256), Texel(3, 0));
+			TS_ASSERT_EQUALS(texel(table, 0, 0), Texel(0, 0));
+
+			// Header, then the frames with their end time
+			TS_ASSERT_EQUALS(texel(table, 0, 2), Texel(2, 300));
+			TS_ASSERT_EQUALS(texel(table, 1, 2), Texel(2, 100));
+			TS_ASSERT_EQUALS(texel(table, 2, 2), Texel(3, 300));
+			TS_ASSERT_EQUALS(texel(table, 3, 2), Texel(0, 0));
+
+			TS_ASSERT_EQUALS(texel(table, 0, 3), Texel(1, 250));
+			TS_ASSERT_EQUALS(texel(table, 1, 3), Texel(270, 250));
+		}
+
+		void testLongAnimation() {
+			Tile tile;
+			for (u16 i = 0 ; i < 300 ; ++i)
+				tile.addAnimationFrame(1, 60000);
+
+			TilemapAnimationTable table{1, 0};
+			table.addAnimation(0, tile);
+
+			// Frames past the width of the table are dropped, end times are clamped
+			TS_ASSERT_EQUALS(texel(table, 0, 1), Texel(255, 0xffff));
+			TS_ASSERT_EQUALS(texel(table, 1, 1), Texel(1, 60000));
+			TS_ASSERT_EQUALS(texel(table, 2, 1), Texel(1, 0xffff));
+			TS_ASSERT_EQUALS(table.period(), 0xffffu * (TilemapAnimationTable::maxPeriod / 0xffffu));
+		}
+
+		void testPeriodOverflow() {
+			Tile tile1, tile2, tile3;
+			tile1.addAnimationFrame(1, 65521);
+			tile2.addAnimationFrame(1, 65519);
+			tile3.addAnimationFrame(1, 16);
+
+			TilemapAnimationTable table{4, 0};
+			table.addAnimation(0, tile1);
+			table.addAnimation(1, tile2);
+			table.addAnimation(2, tile3);
+
+			// The second duration would need a period above the maximum, so only it wraps early
+			TS_ASSERT_LESS_THAN_EQUALS(table.period(), TilemapAnimationTable::maxPeriod);
+			TS_ASSERT_EQUALS(table.period() % 65521u, 0u);
+			TS_ASSERT_EQUALS(table.period() % 16u, 0u);
+			TS_ASSERT_DIFFERS(table.period() % 65519u, 0u);
+		}
+
+	private:
+		static Texel texel(const TilemapAnimationTable &table, u16 x, u16 y) {
+			const u8 *texel = &table.pixels()[(size_t(y) * TilemapAnimationTable::width + x) * 4];
+			return {u16(texel[0] | texel[1] << 8), u16(texel[2] | texel[3] << 8)};
+		}
+};
+
+#endif // TILEMAPANIMATIONTABLETESTS_HPP_
@@ -0,0 +1,74 @@
+/*
+ * =====================================================================================
+ *
+ *  GameKit
+ *
+ *  Copyright (C) 2018-2020 Unarelith, Quentin Bazin <openminer@unarelith.net>
+ *  Copyright (C) 2020 the GameKit contributors (see CONTRIBUTORS.md)
+ *
+ *  This file is part of GameKit.
+ *
+ *  GameKit is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  GameKit is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GameKit; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * =====================================================================================
+ */
+#ifndef TIMINGWHEELTESTS_HPP_
+#define TIMINGWHEELTESTS_HPP_
+
+#include <algorithm>
+
+#include <cxxtest/TestSuite.h>
+
+#include "gk/core/TimingWheel.hpp"
+
+using namespace gk;
+
+class TimingWheelTests : public CxxTest::TestSuite  {
+	public:
+		void testAdvance() {
+			TimingWheel<u32> wheel;
+			wheel.advance(1000, [] (u32) { TS_FAIL("Empty wheel"); });
+
+			// Dates spread over all the levels, the value being the date
+			std::vector<u32> dates;
+			u32 seed = 42;
+			for (int i = 0 ; i < 2000 ; ++i) {
+				seed = seed * 1103515245u + 12345u;
+				u32 date = 1000 + (seed >> 8) % (1u << (i % 4 == 0 ? 20 : 12));
+				dates.emplace_back(date);
+				wheel.schedule(date, date);
+			}
+
+			wheel.schedule(500, 500);
+			dates.emplace_back(500);
+
+			std::sort(dates.begin(), dates.end());
+
+			std::vector<u32> expired;
+			u32 time = 1000;
+			while (wheel.size() != 0) {
+				wheel.advance(time, [&] (u32 date) {
+					TS_ASSERT_LESS_THAN_EQUALS(date, std::max(time, 1001u));
+					expired.emplace_back(date);
+				});
+
+				time += 16;
+			}
+
+			TS_ASSERT_EQUALS(expired, dates);
+		}
+};
+
+#endif // TIMINGWHEELTESTS_HPP_